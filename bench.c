@@ -0,0 +1,292 @@
+/**
+ * @file bench.c
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Source file used to time CHash lookups under representative workloads.
+ * It links against the math library for the Zipf sampler and should be built
+ * with optimizations enabled, e.g.
+ * <code>gcc -std=c17 -O2 bench.c chash.c chash_robin.c chash_freeze.c -lm
+ * -o bench</code>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "chash.h"
+#include "chash_freeze.h"
+#include "chash_robin.h"
+
+/**
+ * @brief Number of distinct keys stored in each benchmarked table
+ */
+#define BENCH_KEYS 100000
+
+/**
+ * @brief Number of lookups timed per run
+ */
+#define BENCH_LOOKUPS 5000000
+
+/**
+ * @brief Average number of properties per slot. The table is deliberately
+ * undersized so that list order, and not just hashing, dominates lookup cost.
+ */
+#define BENCH_LOAD 16
+
+/**
+ * @brief Number of delete/insert pairs between reports of the churn benchmark.
+ * As it is not a multiple of <code>BENCH_KEYS</code>, each round ends on a
+ * different window of keys.
+ */
+#define BENCH_CHURN (1UL << 20)
+
+/**
+ * @brief Number of keys frozen by the minimal perfect hash benchmark, on the
+ * order of a geolocation database or product catalog
+ */
+#define BENCH_FREEZE_KEYS 6000000
+
+/**
+ * @brief The <code>_zipf</code> function fills <code>p_sequence</code> with
+ * <code>count</code> key indices drawn from a Zipf distribution with exponent
+ * <code>exponent</code> over <code>keys</code> ranks, such that rank zero is
+ * the most popular. Indices are drawn ahead of time by inverting the
+ * cumulative distribution with a binary search, so that sampling cost does not
+ * pollute the timed loop.
+ *
+ * @param p_sequence unsigned long int* Output array of key indices
+ * @param count unsigned long int Number of indices to draw
+ * @param keys unsigned long int Number of distinct keys
+ * @param exponent double Skew of the distribution; 0 is uniform
+ * @return void
+ */
+static void _zipf(unsigned long int * p_sequence, unsigned long int count,
+    unsigned long int keys, double exponent) {
+
+  // Declarations
+  double * p_cumulative, total, target;
+  unsigned long int counter, low, high, middle;
+
+  // Definitions
+  p_cumulative = malloc(sizeof(double) * keys);
+  total = 0;
+
+  for (counter = 0; counter < keys; counter++) {
+    total += 1.0 / pow(counter + 1, exponent);
+    p_cumulative[counter] = total;
+  }
+
+  for (counter = 0; counter < count; counter++) {
+    target = total * rand() / ((double) RAND_MAX + 1);
+    low = 0;
+    high = keys - 1;
+
+    while (low < high) {
+      middle = (low + high) / 2;
+
+      if (p_cumulative[middle] < target) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+
+    p_sequence[counter] = low;
+  }
+
+  free(p_cumulative);
+}
+
+/**
+ * @brief The <code>_bench_lookups</code> function builds a table holding
+ * <code>BENCH_KEYS</code> keys with the given <code>flags</code> set, then
+ * times one lookup per index in <code>p_sequence</code> and prints the mean
+ * cost of a lookup in nanoseconds. Keys are inserted in a shuffled order so
+ * that popular keys do not start out at the heads of their lists.
+ *
+ * @param p_label const char* Label printed alongside the result
+ * @param flags unsigned int Table flags to set before inserting keys
+ * @param p_keys t_key* Pre-hashed handles for all keys
+ * @param p_sequence unsigned long int* Key indices to look up, in order
+ * @return void
+ */
+static void _bench_lookups(const char * p_label, unsigned int flags,
+    t_key * p_keys, unsigned long int * p_sequence) {
+
+  // Declarations
+  t_table * p_table;
+  unsigned long int counter, found;
+  clock_t start;
+  double elapsed;
+
+  // Definitions
+  p_table = ch_create(BENCH_KEYS / BENCH_LOAD);
+  p_table->flags = flags;
+  found = 0;
+
+  for (counter = 0; counter < BENCH_KEYS; counter++) {
+    ch_put_h(p_table, &p_keys[(counter * 7919) % BENCH_KEYS], &p_keys[0]);
+  }
+
+  start = clock();
+
+  for (counter = 0; counter < BENCH_LOOKUPS; counter++) {
+    found += ch_get_h(p_table, &p_keys[p_sequence[counter]]) != NULL;
+  }
+
+  elapsed = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+  printf("%-24s %8.1f ns/lookup (%lu found)\n", p_label,
+    elapsed * 1e9 / BENCH_LOOKUPS, found);
+
+  ch_destroy(p_table);
+}
+
+/**
+ * @brief The <code>_bench_churn</code> function keeps a sliding window of
+ * <code>BENCH_KEYS / 2</code> keys in a Robin Hood table loaded to nearly 90
+ * percent, repeatedly deleting the oldest key and inserting the next one. The
+ * probe lengths reported after each round of <code>BENCH_CHURN</code> pairs
+ * should hold steady, since backward-shift deletion leaves no tombstones.
+ *
+ * @param p_keys t_key* Handles for all keys, whose strings are used
+ * @return void
+ */
+static void _bench_churn(t_key * p_keys) {
+
+  // Declarations
+  t_robin * p_table;
+  t_robin_stats stats;
+  unsigned long int oldest, round, counter;
+
+  // Definitions
+  p_table = ch_robin_create(BENCH_KEYS / 2 * 10 / 9 + 1);
+
+  for (oldest = 0; oldest < BENCH_KEYS / 2; oldest++) {
+    ch_robin_put(p_table, p_keys[oldest].p_key, &p_keys[oldest]);
+  }
+
+  oldest = 0;
+
+  for (round = 0; round <= 10; round++) {
+    ch_robin_stats(p_table, &stats);
+    printf("after %8lu pairs: %lu/%lu slots, probe %.3f mean, %lu max\n",
+      round * BENCH_CHURN, stats.count, stats.size, stats.average_probe,
+      stats.max_probe);
+
+    for (counter = 0; counter < BENCH_CHURN; counter++, oldest++) {
+      ch_robin_delete(p_table, p_keys[oldest % BENCH_KEYS].p_key);
+      ch_robin_put(p_table, p_keys[(oldest + BENCH_KEYS / 2) %
+        BENCH_KEYS].p_key, &p_keys[0]);
+    }
+  }
+
+  ch_robin_destroy(p_table);
+}
+
+/**
+ * @brief The <code>_bench_freeze</code> function freezes a table of
+ * <code>BENCH_FREEZE_KEYS</code> keys, reporting the time taken to construct
+ * the minimal perfect hash, then looks up every key in the frozen table and
+ * reports the mean cost of a lookup and the number of keys not found, which
+ * should be zero.
+ *
+ * @return void
+ */
+static void _bench_freeze(void) {
+
+  // Declarations
+  t_table * p_table;
+  t_frozen * p_frozen;
+  char * p_strings;
+  unsigned long int counter, missing;
+  clock_t start;
+  double elapsed;
+
+  // Definitions
+  p_strings = malloc(24UL * BENCH_FREEZE_KEYS);
+  p_table = ch_create(BENCH_FREEZE_KEYS);
+  missing = 0;
+
+  for (counter = 0; counter < BENCH_FREEZE_KEYS; counter++) {
+    sprintf(p_strings + counter * 24, "geo/%lu", counter * 7919);
+    ch_put(p_table, p_strings + counter * 24, p_strings + counter * 24);
+  }
+
+  start = clock();
+  p_frozen = ch_freeze(p_table);
+  elapsed = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+  if (p_frozen == NULL) {
+    printf("construction failed after %.2f s\n", elapsed);
+  } else {
+    printf("%-24s %8.2f s\n", "construction", elapsed);
+    start = clock();
+
+    for (counter = 0; counter < BENCH_FREEZE_KEYS; counter++) {
+      missing += ch_frozen_get(p_frozen, p_strings + counter * 24) !=
+        p_strings + counter * 24;
+    }
+
+    elapsed = (double) (clock() - start) / CLOCKS_PER_SEC;
+    printf("%-24s %8.1f ns/lookup (%lu missing)\n", "frozen",
+      elapsed * 1e9 / BENCH_FREEZE_KEYS, missing);
+  }
+
+  ch_frozen_destroy(p_frozen);
+  ch_destroy(p_table);
+  free(p_strings);
+}
+
+/**
+ * @brief The <code>main</code> function drives each benchmark in turn. Keys
+ * are pre-hashed into <code>t_key</code> handles so that only the table walk
+ * itself is timed.
+ *
+ * @return int Default of 0
+ */
+int main(void) {
+
+  // Declarations
+  t_key * p_keys;
+  char * p_strings;
+  unsigned long int * p_sequence, counter;
+
+  // Definitions
+  p_keys = malloc(sizeof(t_key) * BENCH_KEYS);
+  p_strings = malloc(32 * BENCH_KEYS);
+  p_sequence = malloc(sizeof(unsigned long int) * BENCH_LOOKUPS);
+  srand(42);
+
+  for (counter = 0; counter < BENCH_KEYS; counter++) {
+    sprintf(p_strings + counter * 32, "bench/key/%lu", counter);
+    p_keys[counter] = ch_key(p_strings + counter * 32);
+  }
+
+  printf("-----Zipf lookups (s = 1.0), %d keys, load %d-----\n\n",
+    BENCH_KEYS, BENCH_LOAD);
+  _zipf(p_sequence, BENCH_LOOKUPS, BENCH_KEYS, 1.0);
+  _bench_lookups("chained", 0, p_keys, p_sequence);
+  _bench_lookups("chained, move-to-front", CH_MOVE_TO_FRONT, p_keys,
+    p_sequence);
+
+  printf("\n-----Uniform lookups, %d keys, load %d-----\n\n",
+    BENCH_KEYS, BENCH_LOAD);
+  _zipf(p_sequence, BENCH_LOOKUPS, BENCH_KEYS, 0.0);
+  _bench_lookups("chained", 0, p_keys, p_sequence);
+  _bench_lookups("chained, move-to-front", CH_MOVE_TO_FRONT, p_keys,
+    p_sequence);
+
+  printf("\n-----Robin Hood churn, %d keys resident-----\n\n",
+    BENCH_KEYS / 2);
+  _bench_churn(p_keys);
+
+  printf("\n-----Minimal perfect hash, %d keys-----\n\n", BENCH_FREEZE_KEYS);
+  _bench_freeze();
+
+  free(p_keys);
+  free(p_strings);
+  free(p_sequence);
+
+  return 0;
+}
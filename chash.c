@@ -5,275 +5,2265 @@
  * @brief Source file for CHash, a single-threaded hash table implementation
  */
 
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <sys/mman.h>
 #include "chash.h"
 
 /**
- * @brief Arguably the module's most important function, the <code>_hash</code>
- * function is used to hash a given string value passed as a formal parameter
- * to a unique <code>long int</code>. This particular implementation is a
- * variation of cryptographer Daniel J. Bernstein's famous string hashing
- * function "djb2." Though it makes use of the magic number 33, it does not use
- * the prime magic number 5381, instead starting from 0 and incrementing based
- * on the length of the passed string and the ASCII value of the current
- * <code>char</code> in the string.
- * <br />
- * <br />
- * While perhaps not the most efficient of hashing functions, <code>_hash</code>
- * ensures that for tables for which there exists an equal number of hash slots
- * and key/value pairs (i.e. four properties and four slots), each key/value
- * pair will have its own slot, thus ensuring the linked list fallback built in
- * to ensure multiple properties can exist at the same slot is unneeded in such
- * cases.
+ * @brief Size of the huge pages to which mapped slot arrays are rounded and
+ * aligned, that of a second-level page table entry on common hardware
+ */
+#define CH_HUGE_PAGE (1UL << 21)
+
+/**
+ * @brief Bytes of key storage set aside by <code>ch_reserve</code> for each
+ * property reserved, enough for most identifiers and their terminators
+ */
+#define CH_RESERVE_KEY 24
+
+/**
+ * @brief Bit of a property's <code>reserved</code> member set if the property
+ * itself was carved from a <code>ch_reserve</code> block
+ */
+#define CH_RESERVED_PROPERTY 0x1
+
+/**
+ * @brief Bit of a property's <code>reserved</code> member set if its key was
+ * carved from a <code>ch_reserve</code> block
+ */
+#define CH_RESERVED_KEY 0x2
+
+/**
+ * @brief Number of least recently used properties <code>_evict</code> examines
+ * for an expired one, which is dropped in preference to evicting a live one
+ */
+#define CH_EVICT_SAMPLE 8
+
+/**
+ * @brief The <code>t_reserve</code> <code>struct</code> heads each block
+ * allocated by <code>ch_reserve</code>. It is followed by the reserved
+ * properties and then by the key storage set aside for them.
+ */
+typedef struct s_reserve {
+  struct s_reserve * p_next;    /**< Block reserved before this one */
+  unsigned long int length;     /**< Length of the block, header included */
+} t_reserve;
+
+/**
+ * @brief The <code>t_stream</code> <code>struct</code> carries the caller's
+ * function and state through <code>ch_set_each</code> to <code>_stream</code>.
+ */
+typedef struct {
+  void (* p_visit)(const char * p_key, void * p_value, void * p_context);
+  void * p_context;             /**< State passed to p_visit */
+} t_stream;
+
+/**
+ * @brief Arguably the module's most important function, the <code>_hash</code>
+ * function is used to hash a given string value passed as a formal parameter
+ * to a unique <code>long int</code>. This particular implementation is a
+ * variation of cryptographer Daniel J. Bernstein's famous string hashing
+ * function "djb2." Though it makes use of the magic number 33, it does not use
+ * the prime magic number 5381, instead starting from 0 and incrementing based
+ * on the length of the passed string and the ASCII value of the current
+ * <code>char</code> in the string.
+ * <br />
+ * <br />
+ * While perhaps not the most efficient of hashing functions, <code>_hash</code>
+ * ensures that for tables for which there exists an equal number of hash slots
+ * and key/value pairs (i.e. four properties and four slots), each key/value
+ * pair will have its own slot, thus ensuring the linked list fallback built in
+ * to ensure multiple properties can exist at the same slot is unneeded in such
+ * cases.
+ *
+ * @see http://www.cse.yorku.ca/~oz/hash.html
+ * @param p_key const char* The string to be hashed
+ * @param length unsigned long int Length of the string, as per strlen
+ * @return value unsigned long int The resultant hash <code>int</code> value
+ */
+static unsigned long int _hash(const char * p_key, unsigned long int length) {
+
+  // Declarations
+  unsigned long int counter;
+  unsigned long int value;
+
+  // Definitions
+  value = 0L;
+  counter = 0;
+
+  // Update value based on previous value, string length, and ASCII value
+  while (counter < length) {
+    value = value * 33 + p_key[counter++];
+  }
+
+  return value;
+}
+
+/**
+ * @brief The <code>_now</code> helper function reads the monotonic clock in
+ * milliseconds. The monotonic clock is used rather than the wall clock so that
+ * adjustments to the system time neither resurrect nor prematurely expire
+ * properties.
+ *
+ * @return unsigned long int Milliseconds elapsed since an arbitrary epoch
+ */
+static unsigned long int _now(void) {
+
+  // Declaration
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (unsigned long int) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/**
+ * @brief The <code>_malloc</code> helper function adapts the standard library
+ * <code>malloc</code> to the signature of <code>t_allocator</code>.
+ *
+ * @param size unsigned long int Number of bytes to allocate
+ * @param p_context void* Unused
+ * @return void* The block, or <code>NULL</code>
+ */
+static void * _malloc(unsigned long int size, void * p_context) {
+  (void) p_context;
+  return malloc(size);
+}
+
+/**
+ * @brief The <code>_realloc</code> helper function adapts the standard library
+ * <code>realloc</code> to the signature of <code>t_allocator</code>.
+ *
+ * @param p_block void* The block to be resized
+ * @param size unsigned long int New size of the block in bytes
+ * @param p_context void* Unused
+ * @return void* The resized block, or <code>NULL</code>
+ */
+static void * _realloc(void * p_block, unsigned long int size,
+    void * p_context) {
+  (void) p_context;
+  return realloc(p_block, size);
+}
+
+/**
+ * @brief The <code>_free</code> helper function adapts the standard library
+ * <code>free</code> to the signature of <code>t_allocator</code>.
+ *
+ * @param p_block void* The block to be released
+ * @param p_context void* Unused
+ * @return void
+ */
+static void _free(void * p_block, void * p_context) {
+  (void) p_context;
+  free(p_block);
+}
+
+/**
+ * @brief The allocator used by tables created without one
+ */
+static const t_allocator ALLOCATOR = {_malloc, _realloc, _free, NULL};
+
+/**
+ * @brief The <code>_transparent</code> helper function determines whether the
+ * system will back advised memory with transparent huge pages at all, which
+ * <code>madvise</code> does not report: it accepts the advice even when they
+ * are disabled.
+ *
+ * @return int 1 if transparent huge pages are enabled, otherwise 0
+ */
+static int _transparent(void) {
+
+  // Declarations
+  FILE * p_file;
+  char setting[64];
+  int enabled;
+
+  if ((p_file = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r")) ==
+      NULL) {
+    return 0;
+  }
+
+  enabled = fgets(setting, sizeof(setting), p_file) != NULL &&
+    strstr(setting, "[never]") == NULL;
+  fclose(p_file);
+
+  return enabled;
+}
+
+/**
+ * @brief The <code>_slots</code> helper function allocates an array of
+ * <code>size</code> slots for <code>p_table</code>, recording in the table how
+ * it was obtained. If <code>huge_pages</code> is set, the array is mapped from
+ * the reserved huge page pool or, failing that, mapped on a huge page boundary
+ * with the kernel advised to back it with transparent huge pages, which is
+ * recorded only if the system has them enabled. Should mapping fail
+ * altogether, the table's allocator is used instead.
+ * <br />
+ * <br />
+ * Every slot of the array returned is <code>NULL</code>. Mapped arrays and
+ * those from the default allocator, which uses <code>calloc</code>, are zeroed
+ * by the kernel as each page is first touched, so creating even a table of a
+ * billion slots touches none of them; only a custom allocator's array must be
+ * cleared up front.
+ *
+ * @param p_table t_table* The table for which to allocate
+ * @param size unsigned long int Number of slots
+ * @param huge_pages unsigned int Nonzero to try mapping on huge pages
+ * @return t_property** The zeroed array, or <code>NULL</code>
+ */
+static t_property ** _slots(t_table * p_table, unsigned long int size,
+    unsigned int huge_pages) {
+
+  // Declarations
+  unsigned char * p_region;
+  unsigned long int length, slack;
+
+  // Definitions
+  p_table->mapped = 0;
+  p_table->pages = CH_PAGES_NORMAL;
+  length = (sizeof(t_property *) * size + CH_HUGE_PAGE - 1) &
+    ~(CH_HUGE_PAGE - 1);
+
+  if (huge_pages && length != 0) {
+#ifdef MAP_HUGETLB
+    p_region = mmap(NULL, length, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+    if (p_region != MAP_FAILED) {
+      p_table->mapped = length;
+      p_table->pages = CH_PAGES_EXPLICIT;
+      return (t_property **) p_region;
+    }
+#endif
+
+    // Map a page extra, then trim both ends to leave an aligned region
+    p_region = mmap(NULL, length + CH_HUGE_PAGE, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (p_region != MAP_FAILED) {
+      slack = (CH_HUGE_PAGE - (unsigned long int) p_region % CH_HUGE_PAGE) %
+        CH_HUGE_PAGE;
+
+      if (slack != 0) {
+        munmap(p_region, slack);
+      }
+
+      munmap(p_region + slack + length, CH_HUGE_PAGE - slack);
+      p_region += slack;
+      p_table->mapped = length;
+
+#ifdef MADV_HUGEPAGE
+      if (_transparent() && madvise(p_region, length, MADV_HUGEPAGE) == 0) {
+        p_table->pages = CH_PAGES_TRANSPARENT;
+      }
+#endif
+
+      return (t_property **) p_region;
+    }
+  }
+
+  // Zeroed memory from calloc is mapped lazily, so large arrays cost nothing
+  if (p_table->allocator.p_malloc == _malloc) {
+    return calloc(size, sizeof(t_property *));
+  }
+
+  if ((p_region = p_table->allocator.p_malloc(sizeof(t_property *) * size,
+      p_table->allocator.p_context)) != NULL) {
+    memset(p_region, 0, sizeof(t_property *) * size);
+  }
+
+  return (t_property **) p_region;
+}
+
+/**
+ * @brief The <code>_unslot</code> helper function releases the slot array
+ * <code>p_entries</code> of <code>p_table</code>, unmapping it if it was mapped
+ * by <code>_slots</code> and otherwise returning it to the table's allocator.
+ *
+ * @param p_table t_table* The table owning the array
+ * @param p_entries t_property** The array to be released
+ * @param mapped unsigned long int Length of the mapping, or 0 if allocated
+ * @return void
+ */
+static void _unslot(t_table * p_table, t_property ** p_entries,
+    unsigned long int mapped) {
+  if (mapped != 0) {
+    munmap(p_entries, mapped);
+  } else {
+    p_table->allocator.p_free(p_entries, p_table->allocator.p_context);
+  }
+}
+
+/**
+ * @brief The <code>_resize</code> helper function moves every property of
+ * <code>p_table</code> into a new slot array of <code>size</code> slots,
+ * placing each by its cached hash so that no key is rehashed, and releases the
+ * old array. A mapped array is replaced by another. Growth that would exceed
+ * the table's budget is refused, as is any resize while a snapshot shares the
+ * table's lists or if allocation fails.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param size unsigned long int New number of slots
+ * @return int 0 on success, -1 if the table was left unchanged
+ */
+static int _resize(t_table * p_table, unsigned long int size) {
+
+  // Declarations
+  t_property ** p_entries, * p_entry, * p_next;
+  unsigned long int mapped, counter;
+  unsigned int pages;
+
+  if (p_table->p_snapshot != NULL || (p_table->budget != 0 &&
+      size > p_table->size && p_table->bytes + sizeof(t_property *) *
+        (size - p_table->size) > p_table->budget)) {
+    return -1;
+  }
+
+  // Keep the old array's backing, which _slots overwrites, to release it
+  mapped = p_table->mapped;
+  pages = p_table->pages;
+
+  if ((p_entries = _slots(p_table, size, mapped != 0)) == NULL) {
+    p_table->mapped = mapped;
+    p_table->pages = pages;
+    return -1;
+  }
+
+  for (counter = 0; counter < p_table->size; counter++) {
+    for (p_entry = p_table->p_entries[counter]; p_entry != NULL;
+        p_entry = p_next) {
+      p_next = p_entry->p_next;
+      p_entry->p_next = p_entries[p_entry->hash % size];
+      p_entries[p_entry->hash % size] = p_entry;
+    }
+  }
+
+  _unslot(p_table, p_table->p_entries, mapped);
+  p_table->bytes = p_table->bytes - sizeof(t_property *) * p_table->size +
+    sizeof(t_property *) * size;
+  p_table->p_entries = p_entries;
+  p_table->size = size;
+  p_table->cursor %= size;
+
+  return 0;
+}
+
+/**
+ * @brief The <code>_shrink</code> helper function halves the slot array of an
+ * elastic table whose load has fallen below its low watermark, provided the
+ * result is no smaller than the table's minimum. It is called only once a
+ * removal is complete, never while a list is being walked.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @return void
+ */
+static void _shrink(t_table * p_table) {
+  if (p_table->low_watermark != 0 && p_table->size / 2 >= p_table->minimum &&
+      p_table->count * 100 < p_table->low_watermark * p_table->size) {
+    _resize(p_table, p_table->size / 2);
+  }
+}
+
+/**
+ * @brief The <code>_clear</code> helper function is a private function that is
+ * used to deallocate all space previously reserved in heap memory for a
+ * <code>t_property</code> <code>struct</code> and its associated string data
+ * member <code>p_key</code>. This function is used by the public functions
+ * <code>ch_clear</code> and <code>ch_destroy</code> to clean out an extant hash
+ * table as needed. Both are returned through the table's allocator, save that
+ * a property from a <code>ch_reserve</code> block goes back on the table's
+ * spare list, and a key from one is simply abandoned. Which were reserved is
+ * read from the property's <code>reserved</code> bits, so the check takes
+ * constant time however many blocks the table has reserved.
+ *
+ * @param p_table t_table* The table owning the property
+ * @param p_entry t_property* The specific <code>t_property</code> to be cleared
+ * @return void
+ */
+static void _clear(t_table * p_table, t_property * p_entry) {
+
+  // Free key space if extant
+  if (p_entry->p_key != NULL) {
+    if (!(p_entry->reserved & CH_RESERVED_KEY)) {
+      p_table->allocator.p_free(p_entry->p_key, p_table->allocator.p_context);
+    }
+
+    p_entry->p_key = NULL;
+  }
+
+  // Keep a reserved entry for reuse
+  if (p_entry->reserved & CH_RESERVED_PROPERTY) {
+    p_entry->p_next = p_table->p_spare;
+    p_table->p_spare = p_entry;
+    p_table->spares++;
+    return;
+  }
+
+  // Free entry itself if extant
+  if (p_entry != NULL) {
+    p_table->allocator.p_free(p_entry, p_table->allocator.p_context);
+    p_entry = NULL;
+  }
+}
+
+/**
+ * @brief The <code>_construct</code> helper function is a private function that
+ * is used to build a <code>t_property</code> <code>struct</code> from the key
+ * and value passed as formal parameters. It allocates space in memory for the
+ * new object and the string key, sets the various members, and returns the
+ * <code>struct</code> for inclusion in the hash table. It is invoked primarily
+ * by <code>ch_put</code> to assign new properties. The key's hash, already
+ * computed by the caller, is cached in the new property. Memory is taken from
+ * that reserved by <code>ch_reserve</code> while any remains, and otherwise
+ * obtained from the table's allocator.
+ *
+ * @param p_table t_table* The table that will own the property
+ * @param p_handle const t_key* The pre-hashed key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return t_property*
+ */
+static t_property * _construct(t_table * p_table, const t_key * p_handle,
+    void * p_value) {
+
+  // Declaration
+  t_property * p_entry;
+
+  // Allocation definitions
+  if ((p_entry = p_table->p_spare) != NULL) {
+    p_table->p_spare = p_entry->p_next;
+    p_table->spares--;
+    p_entry->reserved &= CH_RESERVED_PROPERTY;
+  } else if ((p_entry = p_table->allocator.p_malloc(sizeof(t_property),
+      p_table->allocator.p_context)) != NULL) {
+    p_entry->reserved = 0;
+  } else {
+    return NULL;
+  }
+
+  if ((unsigned long int) (p_table->p_key_limit - p_table->p_key_cursor) >
+      p_handle->length) {
+    p_entry->p_key = p_table->p_key_cursor;
+    p_entry->reserved |= CH_RESERVED_KEY;
+    p_table->p_key_cursor += p_handle->length + 1;
+  } else {
+    p_entry->p_key = p_table->allocator.p_malloc(p_handle->length + 1,
+      p_table->allocator.p_context);
+  }
+
+  // Ensure space was successfully allocated for the key as well
+  if (!p_entry->p_key) {
+    _clear(p_table, p_entry);
+    return NULL;
+  }
+
+  // Copy string, including its terminator, to data member from handle
+  memcpy(p_entry->p_key, p_handle->p_key, p_handle->length + 1);
+  p_entry->hash = p_handle->hash;
+
+  // Set value as formal parameter void pointer
+  p_entry->p_value = p_value;
+
+  // No next by default, no expiry, and not yet on the recency list
+  p_entry->p_next = NULL;
+  p_entry->expires = 0;
+  p_entry->bytes = 0;
+  p_entry->p_newer = NULL;
+  p_entry->p_older = NULL;
+
+  return p_entry;
+}
+
+/**
+ * @brief The <code>_touch</code> helper function makes <code>p_entry</code> the
+ * most recently used property of a table with a capacity or budget, moving it
+ * to the newest end of the recency list, or adding it there if it is new. A
+ * property is on the list if it is the newest or has a newer neighbor.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_entry t_property* The property used
+ * @return void
+ */
+static void _touch(t_table * p_table, t_property * p_entry) {
+
+  if ((p_table->capacity == 0 && p_table->budget == 0) ||
+      p_entry == p_table->p_newest) {
+    return;
+  }
+
+  // Unlink from the current position, if listed
+  if (p_entry->p_newer != NULL) {
+    p_entry->p_newer->p_older = p_entry->p_older;
+    *((p_entry->p_older != NULL) ? &p_entry->p_older->p_newer
+      : &p_table->p_oldest) = p_entry->p_newer;
+  }
+
+  // Push onto the newest end
+  p_entry->p_newer = NULL;
+  p_entry->p_older = p_table->p_newest;
+  *((p_table->p_newest != NULL) ? &p_table->p_newest->p_newer
+    : &p_table->p_oldest) = p_entry;
+  p_table->p_newest = p_entry;
+}
+
+/**
+ * @brief The <code>_forget</code> helper function accounts for the removal of
+ * <code>p_entry</code>, already unlinked from its slot's list, by taking it
+ * off the recency list of a table with a capacity or budget, and deducting it
+ * from the count and the bytes charged.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_entry t_property* The property removed
+ * @return void
+ */
+static void _forget(t_table * p_table, t_property * p_entry) {
+
+  if (p_table->capacity != 0 || p_table->budget != 0) {
+    *((p_entry->p_newer != NULL) ? &p_entry->p_newer->p_older
+      : &p_table->p_newest) = p_entry->p_older;
+    *((p_entry->p_older != NULL) ? &p_entry->p_older->p_newer
+      : &p_table->p_oldest) = p_entry->p_newer;
+  }
+
+  p_table->count--;
+  p_table->bytes -= p_entry->bytes;
+}
+
+/**
+ * @brief The <code>_unlink</code> helper function removes <code>p_entry</code>
+ * from its slot's list, which is walked to find the link referring to it, and
+ * from the table's accounting. The property is not deallocated.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_entry t_property* The property to be removed
+ * @return void
+ */
+static void _unlink(t_table * p_table, t_property * p_entry) {
+
+  // Declaration
+  t_property ** p_link;
+
+  // Definition
+  p_link = &p_table->p_entries[p_entry->hash % p_table->size];
+
+  while (*p_link != p_entry) {
+    p_link = &(*p_link)->p_next;
+  }
+
+  *p_link = p_entry->p_next;
+  _forget(p_table, p_entry);
+}
+
+/**
+ * @brief The <code>_drop</code> helper function unlinks the expired property
+ * at <code>*p_link</code>, hands its key and value to the table's
+ * <code>p_expire</code> function if one is set, and deallocates it.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_link t_property** The link referring to the expired property
+ * @return void
+ */
+static void _drop(t_table * p_table, t_property ** p_link) {
+
+  // Declaration
+  t_property * p_entry;
+
+  // Definition
+  p_entry = *p_link;
+
+  *p_link = p_entry->p_next;
+  _forget(p_table, p_entry);
+
+  if (p_table->p_expire != NULL) {
+    p_table->p_expire(p_entry->p_key, p_entry->p_value);
+  }
+
+  _clear(p_table, p_entry);
+}
+
+/**
+ * @brief The <code>_evict</code> helper function makes room in a table with a
+ * capacity or budget. If one of the <code>CH_EVICT_SAMPLE</code> least recently
+ * used properties, save the most recently used, has expired, it is dropped
+ * through the table's <code>p_expire</code> function as <code>ch_get</code>
+ * would. Otherwise the least recently used property is removed, its key and
+ * value being passed to the table's <code>p_evict</code> function, if set,
+ * before it is deallocated. Either way, only the victim's own slot's list need
+ * be walked to unlink it, and an elastic table may then shrink.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @return void
+ */
+static void _evict(t_table * p_table) {
+
+  // Declarations
+  t_property * p_victim, ** p_link;
+  unsigned long int now, counter;
+
+  // Definitions
+  now = _now();
+  p_victim = p_table->p_oldest;
+
+  // Expired properties are dropped as such rather than counted as evictions
+  for (counter = 0; counter < CH_EVICT_SAMPLE &&
+      p_victim != p_table->p_newest; counter++) {
+    if (p_victim->expires != 0 && p_victim->expires <= now) {
+      p_link = &p_table->p_entries[p_victim->hash % p_table->size];
+
+      while (*p_link != p_victim) {
+        p_link = &(*p_link)->p_next;
+      }
+
+      _drop(p_table, p_link);
+      _shrink(p_table);
+      return;
+    }
+
+    p_victim = p_victim->p_newer;
+  }
+
+  p_victim = p_table->p_oldest;
+
+  _unlink(p_table, p_victim);
+  p_table->evictions++;
+
+  if (p_table->p_evict != NULL) {
+    p_table->p_evict(p_victim->p_key, p_victim->p_value);
+  }
+
+  _clear(p_table, p_victim);
+  _shrink(p_table);
+}
+
+/**
+ * @brief The <code>_charge</code> helper function recomputes the bytes charged
+ * for <code>p_entry</code>, whose key is <code>length</code> characters long,
+ * after its value has been set, and updates the table's total to match. If
+ * the table then exceeds its budget, least recently used properties other
+ * than <code>p_entry</code> are evicted until it does not, unless the table's
+ * policy is <code>CH_BUDGET_FAIL</code>. A property too large to fit the
+ * budget even in an otherwise empty table is refused before anything is
+ * evicted, and its charge left as it was. Only once the write is accepted is
+ * the least recently used property evicted from a table past its capacity, so
+ * that a refused write never costs another property its place.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_entry t_property* The property whose value was set
+ * @param length unsigned long int Length of the property's key
+ * @return int 1 if the table is within its budget, otherwise 0
+ */
+static int _charge(t_table * p_table, t_property * p_entry,
+    unsigned long int length) {
+
+  // Declaration
+  unsigned long int bytes;
+
+  // Definitions
+  bytes = sizeof(t_property) + length + 1;
+
+  if (p_table->p_size != NULL && p_entry->p_value != NULL) {
+    bytes += p_table->p_size(p_entry->p_value);
+  }
+
+  // No amount of eviction makes room for a property larger than the budget
+  if (p_table->budget != 0 && sizeof(t_table) + sizeof(t_property *) *
+      p_table->size + bytes > p_table->budget) {
+    return 0;
+  }
+
+  p_table->bytes = p_table->bytes - p_entry->bytes + bytes;
+  p_entry->bytes = bytes;
+
+  // Make room, unless forbidden or only the property itself remains
+  while (p_table->budget != 0 && p_table->bytes > p_table->budget) {
+    if (p_table->policy == CH_BUDGET_FAIL || p_table->p_oldest == p_entry) {
+      return 0;
+    }
+
+    _evict(p_table);
+  }
+
+  // Make room for a new property by evicting the least recently used
+  if (p_table->capacity != 0 && p_table->count > p_table->capacity) {
+    _evict(p_table);
+  }
+
+  return 1;
+}
+
+/**
+ * @brief The <code>_assign</code> helper function maps <code>p_value</code>
+ * and the expiry time <code>expires</code> to the property
+ * <code>p_entry</code> just returned by <code>_locate</code>, and charges the
+ * table for it. Should the table's budget refuse the write, a new property is
+ * removed again, and an extant one has its former value and expiry restored.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_entry t_property* The found or created property
+ * @param p_handle const t_key* The pre-hashed key of the key/value pair
+ * @param inserted int 1 if the property was created by <code>_locate</code>
+ * @param p_value void* A void pointer to the address of the associated value
+ * @param expires unsigned long int Expiry time in milliseconds, or 0
+ * @return void* The value, or <code>NULL</code> if the write was refused
+ */
+static void * _assign(t_table * p_table, t_property * p_entry,
+    const t_key * p_handle, int inserted, void * p_value,
+    unsigned long int expires) {
+
+  // Declarations
+  void * p_previous;
+  unsigned long int previous_expires;
+
+  // Definitions
+  p_previous = p_entry->p_value;
+  previous_expires = p_entry->expires;
+
+  p_entry->p_value = p_value;
+  p_entry->expires = expires;
+
+  if (_charge(p_table, p_entry, p_handle->length)) {
+    return p_value;
+  }
+
+  // Undo the write, which the budget does not allow
+  if (inserted) {
+    _unlink(p_table, p_entry);
+    _clear(p_table, p_entry);
+  } else {
+    p_entry->p_value = p_previous;
+    p_entry->expires = previous_expires;
+    _charge(p_table, p_entry, p_handle->length);
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief The <code>_reserve</code> helper function allocates a single block
+ * holding <code>count</code> properties, which are pushed onto the table's
+ * spare list so as to be handed out in address order, and
+ * <code>key_bytes</code> bytes of key storage, which replaces whatever was
+ * left of any earlier block's.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param count unsigned long int Number of properties to reserve
+ * @param key_bytes unsigned long int Bytes of key storage to reserve
+ * @return int 0 on success, -1 if the block could not be allocated
+ */
+static int _reserve(t_table * p_table, unsigned long int count,
+    unsigned long int key_bytes) {
+
+  // Declarations
+  t_reserve * p_reserve;
+  t_property * p_entries;
+  unsigned long int length;
+
+  // Definition
+  length = sizeof(t_reserve) + sizeof(t_property) * count + key_bytes;
+
+  if ((p_reserve = p_table->allocator.p_malloc(length,
+      p_table->allocator.p_context)) == NULL) {
+    return -1;
+  }
+
+  p_reserve->p_next = p_table->p_reserves;
+  p_reserve->length = length;
+  p_table->p_reserves = p_reserve;
+  p_entries = (t_property *) (p_reserve + 1);
+  p_table->p_key_cursor = (char *) (p_entries + count);
+  p_table->p_key_limit = (char *) p_reserve + length;
+
+  // Push the properties in reverse, so that they are handed out in order
+  while (count-- > 0) {
+    p_entries[count].reserved = CH_RESERVED_PROPERTY;
+    p_entries[count].p_next = p_table->p_spare;
+    p_table->p_spare = &p_entries[count];
+    p_table->spares++;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief The <code>_top_up</code> helper function pushes <code>count</code>
+ * singly allocated properties onto the table's spare list, for use when the
+ * key storage left in the newest reserved block still suffices and a whole
+ * new block would only abandon it.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param count unsigned long int Number of properties to add to the spares
+ * @return int 0 on success, -1 if a property could not be allocated, in which
+ * case those allocated before it remain on the spare list
+ */
+static int _top_up(t_table * p_table, unsigned long int count) {
+
+  // Declaration
+  t_property * p_entry;
+
+  while (count-- > 0) {
+    if ((p_entry = p_table->allocator.p_malloc(sizeof(t_property),
+        p_table->allocator.p_context)) == NULL) {
+      return -1;
+    }
+
+    p_entry->reserved = 0;
+    p_entry->p_next = p_table->p_spare;
+    p_table->p_spare = p_entry;
+    p_table->spares++;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief The <code>_spill</code> helper function empties the table's spare
+ * list, freeing those spares allocated singly by <code>_top_up</code>. Spares
+ * carved from reserved blocks are left to be freed with their blocks, which
+ * must not yet have been freed when it is called.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @return void
+ */
+static void _spill(t_table * p_table) {
+
+  // Declaration
+  t_property * p_entry;
+
+  while ((p_entry = p_table->p_spare) != NULL) {
+    p_table->p_spare = p_entry->p_next;
+
+    if (!(p_entry->reserved & CH_RESERVED_PROPERTY)) {
+      p_table->allocator.p_free(p_entry, p_table->allocator.p_context);
+    }
+  }
+
+  p_table->spares = 0;
+}
+
+/**
+ * @brief The <code>_append</code> helper function appends
+ * <code>p_entry</code> to the list at <code>slot</code> of an array being
+ * filled, in constant time. While the array is filled, each slot refers to
+ * the tail of its list rather than the head, and the tail's next pointer
+ * closes the list into a ring by referring back to the head;
+ * <code>_seal</code> restores the usual layout once every property is in.
+ *
+ * @param p_entries t_property** The array being filled
+ * @param slot unsigned long int The slot to which to append
+ * @param p_entry t_property* The property to be appended
+ * @return void
+ */
+static void _append(t_property ** p_entries, unsigned long int slot,
+    t_property * p_entry) {
+
+  if (p_entries[slot] == NULL) {
+    p_entry->p_next = p_entry;
+  } else {
+    p_entry->p_next = p_entries[slot]->p_next;
+    p_entries[slot]->p_next = p_entry;
+  }
+
+  p_entries[slot] = p_entry;
+}
+
+/**
+ * @brief The <code>_seal</code> helper function opens each ring built by
+ * <code>_append</code>, pointing its slot back at the head of the list and
+ * ending the list at its tail.
+ *
+ * @param p_entries t_property** The array filled by <code>_append</code>
+ * @param size unsigned long int Number of slots in the array
+ * @return void
+ */
+static void _seal(t_property ** p_entries, unsigned long int size) {
+
+  // Declarations
+  t_property * p_tail;
+  unsigned long int counter;
+
+  for (counter = 0; counter < size; counter++) {
+    if ((p_tail = p_entries[counter]) != NULL) {
+      p_entries[counter] = p_tail->p_next;
+      p_tail->p_next = NULL;
+    }
+  }
+}
+
+/**
+ * @brief The <code>_shared</code> helper function determines whether the list
+ * at <code>slot</code> is still shared with the table's live snapshot, which
+ * is so until the table first writes to the slot.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param slot unsigned long int The slot in question
+ * @return int 1 if the list is shared, else 0
+ */
+static int _shared(t_table * p_table, unsigned long int slot) {
+  return p_table->p_snapshot != NULL && p_table->p_entries[slot] != NULL &&
+    p_table->p_entries[slot] == p_table->p_snapshot->p_entries[slot];
+}
+
+/**
+ * @brief The <code>_own</code> helper function gives the table a private copy
+ * of the list at <code>slot</code>, if it is shared with a snapshot, before
+ * the table modifies it. The originals are left untouched for the snapshot.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param slot unsigned long int The slot about to be modified
+ * @return int 0 on success, -1 if the copy could not be allocated
+ */
+static int _own(t_table * p_table, unsigned long int slot) {
+
+  // Declarations
+  t_property * p_head, ** p_tail, * p_entry, * p_copy;
+  t_key handle;
+
+  if (!_shared(p_table, slot)) {
+    return 0;
+  }
+
+  // Definitions
+  p_head = NULL;
+  p_tail = &p_head;
+
+  for (p_entry = p_table->p_entries[slot]; p_entry != NULL;
+      p_entry = p_entry->p_next) {
+    handle.p_key = p_entry->p_key;
+    handle.length = strlen(p_entry->p_key);
+    handle.hash = p_entry->hash;
+
+    if ((p_copy = _construct(p_table, &handle, p_entry->p_value)) == NULL) {
+      while ((p_copy = p_head) != NULL) {
+        p_head = p_copy->p_next;
+        _clear(p_table, p_copy);
+      }
+
+      return -1;
+    }
+
+    p_copy->expires = p_entry->expires;
+    p_copy->bytes = p_entry->bytes;
+    *p_tail = p_copy;
+    p_tail = &p_copy->p_next;
+  }
+
+  p_table->p_entries[slot] = p_head;
+
+  return 0;
+}
+
+/**
+ * @brief The <code>_locate</code> helper function performs the list walk
+ * shared by <code>ch_put_h</code> and <code>ch_upsert</code>. It reduces the
+ * handle's hash to a slot and iterates along the list at that slot, comparing
+ * cached hashes before comparing key strings.
+ * If a property bearing the key is found, it is returned as is. Otherwise, a
+ * new property with a <code>NULL</code> value is constructed and appended to
+ * the tail of the list (or placed at the slot itself if the slot is empty), so
+ * that the caller can fill in the value without walking the list a second
+ * time. An expired property bearing the key is reused as though new, its old
+ * value first being passed to the table's <code>p_expire</code> function. In a
+ * table with a capacity, the property returned becomes the most recently used;
+ * a new property may take the table one past its capacity, until
+ * <code>_charge</code> accepts the write and evicts the least recently used.
+ * A list shared with a snapshot is first copied.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_handle const t_key* The pre-hashed key of the key/value pair
+ * @param p_inserted int* Set to 1 if a new property was created, else 0
+ * @return t_property* The found or created property, or <code>NULL</code>
+ */
+static t_property * _locate(t_table * p_table, const t_key * p_handle,
+    int * p_inserted) {
+
+  // Declarations
+  unsigned long int hash;
+  t_property ** p_link, * p_entry;
+
+  // Ensure hash lies between 0 and table's max size
+  hash = p_handle->hash % p_table->size;
+  *p_inserted = 0;
+
+  if (_own(p_table, hash) != 0) {
+    return NULL;
+  }
+
+  // Begin at the slot itself, then follow each property's next pointer
+  p_link = &p_table->p_entries[hash];
+
+  while (*p_link != NULL) {
+
+    // Return match found in linked list
+    if ((*p_link)->hash == p_handle->hash &&
+        strcmp((*p_link)->p_key, p_handle->p_key) == 0) {
+
+      // Recycle an expired match as a fresh property
+      if ((*p_link)->expires != 0 && (*p_link)->expires <= _now()) {
+        if (p_table->p_expire != NULL) {
+          p_table->p_expire((*p_link)->p_key, (*p_link)->p_value);
+        }
+
+        (*p_link)->p_value = NULL;
+        (*p_link)->expires = 0;
+        *p_inserted = 1;
+      }
+
+      _touch(p_table, *p_link);
+      return *p_link;
+    }
+
+    p_link = &(*p_link)->p_next;
+  }
+
+  // Add new property at tail of linked list, or at the empty slot
+  if ((p_entry = *p_link = _construct(p_table, p_handle, NULL)) == NULL) {
+    return NULL;
+  }
+
+  *p_inserted = 1;
+  p_table->count++;
+  _touch(p_table, p_entry);
+
+  // Keep an elastic table's load at or below one property per slot
+  if (p_table->low_watermark != 0 && p_table->count > p_table->size) {
+    _resize(p_table, p_table->size * 2);
+  }
+
+  return p_entry;
+}
+
+/**
+ * @brief The <code>_member</code> helper function determines whether the key
+ * of <code>p_entry</code>, a property of another table, is live in
+ * <code>p_table</code>, comparing cached hashes before any string. Only the
+ * list at <code>slot</code> is searched, and nothing is written, so any number
+ * of threads may search at once.
+ *
+ * @param p_table t_table* A pointer to the table searched
+ * @param slot unsigned long int The slot at which the key would lie
+ * @param p_entry const t_property* The property whose key is sought
+ * @param now unsigned long int The current time in milliseconds
+ * @return int 1 if the key is present and unexpired, otherwise 0
+ */
+static int _member(t_table * p_table, unsigned long int slot,
+    const t_property * p_entry, unsigned long int now) {
+
+  // Declaration
+  t_property * p_match;
+
+  for (p_match = p_table->p_entries[slot]; p_match != NULL;
+      p_match = p_match->p_next) {
+    if (p_match->hash == p_entry->hash &&
+        strcmp(p_match->p_key, p_entry->p_key) == 0) {
+      return p_match->expires == 0 || p_match->expires > now;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief The <code>_sweep</code> helper function passes to
+ * <code>p_emit</code> each unexpired property in partition <code>part</code>
+ * of <code>parts</code> of <code>p_table</code>'s slots whose key is present
+ * in <code>p_other</code> if <code>present</code> is 1, or absent if it is 0.
+ * If <code>p_other</code> is <code>NULL</code>, every property is passed.
+ * Where both tables have the same number of slots, a key lies at the same slot
+ * in each, so the two are walked slot by slot in step, without reducing any
+ * hash.
+ *
+ * @param p_table t_table* A pointer to the table swept
+ * @param p_other t_table* A pointer to the table searched, or <code>NULL</code>
+ * @param present int 1 to pass keys found in <code>p_other</code>, 0 others
+ * @param part unsigned long int The partition of slots to sweep
+ * @param parts unsigned long int Number of partitions
+ * @param p_emit int (*)(const t_property*, void*) Receives each property
+ * @param p_context void* State passed to <code>p_emit</code>
+ * @return int 0 on success, -1 if <code>p_emit</code> failed
+ */
+static int _sweep(t_table * p_table, t_table * p_other, int present,
+    unsigned long int part, unsigned long int parts,
+    int (* p_emit)(const t_property * p_entry, void * p_context),
+    void * p_context) {
+
+  // Declarations
+  t_property * p_entry;
+  unsigned long int slot, last, now;
+  int aligned;
+
+  // Definitions
+  slot = p_table->size / parts * part + p_table->size % parts * part / parts;
+  last = p_table->size / parts * (part + 1) +
+    p_table->size % parts * (part + 1) / parts;
+  aligned = p_other != NULL && p_other->size == p_table->size;
+  now = _now();
+
+  for (; slot < last; slot++) {
+    for (p_entry = p_table->p_entries[slot]; p_entry != NULL;
+        p_entry = p_entry->p_next) {
+      if (p_entry->expires != 0 && p_entry->expires <= now) {
+        continue;
+      }
+
+      if (p_other != NULL && _member(p_other, aligned ? slot
+          : p_entry->hash % p_other->size, p_entry, now) != present) {
+        continue;
+      }
+
+      if (p_emit(p_entry, p_context) != 0) {
+        return -1;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief The <code>_combine</code> helper function passes to
+ * <code>p_emit</code> each key of partition <code>part</code> of
+ * <code>parts</code> of the result of <code>operation</code>. A key of the
+ * union found in both tables is passed once, as the left table's property.
+ *
+ * @param p_left t_table* A pointer to the left operand
+ * @param p_right t_table* A pointer to the right operand
+ * @param operation unsigned int One of the <code>CH_SET_*</code> operations
+ * @param part unsigned long int The partition to compute
+ * @param parts unsigned long int Number of partitions
+ * @param p_emit int (*)(const t_property*, void*) Receives each property
+ * @param p_context void* State passed to <code>p_emit</code>
+ * @return int 0 on success, -1 if <code>p_emit</code> failed
+ */
+static int _combine(t_table * p_left, t_table * p_right,
+    unsigned int operation, unsigned long int part, unsigned long int parts,
+    int (* p_emit)(const t_property * p_entry, void * p_context),
+    void * p_context) {
+
+  switch (operation) {
+    case CH_SET_UNION:
+      return (_sweep(p_left, NULL, 0, part, parts, p_emit, p_context) != 0)
+        ? -1 : _sweep(p_right, p_left, 0, part, parts, p_emit, p_context);
+    case CH_SET_INTERSECTION:
+      return _sweep(p_left, p_right, 1, part, parts, p_emit, p_context);
+    default:
+      return _sweep(p_left, p_right, 0, part, parts, p_emit, p_context);
+  }
+}
+
+/**
+ * @brief The <code>_stream</code> helper function hands the key and value of
+ * <code>p_entry</code> to the caller's function of <code>ch_set_each</code>.
+ *
+ * @param p_entry const t_property* The property in the result
+ * @param p_context void* The <code>t_stream</code> of the caller
+ * @return int Always 0
+ */
+static int _stream(const t_property * p_entry, void * p_context) {
+
+  // Declaration
+  t_stream * p_stream;
+
+  // Definition
+  p_stream = p_context;
+
+  p_stream->p_visit(p_entry->p_key, p_entry->p_value, p_stream->p_context);
+
+  return 0;
+}
+
+/**
+ * @brief The <code>_gather</code> helper function adds a copy of
+ * <code>p_entry</code>, placed by its cached hash and keeping its expiry, to
+ * the table being built by <code>ch_set</code>.
+ *
+ * @param p_entry const t_property* The property in the result
+ * @param p_context void* The table being built
+ * @return int 0 on success, -1 if allocation failed
+ */
+static int _gather(const t_property * p_entry, void * p_context) {
+
+  // Declarations
+  t_table * p_table;
+  t_property * p_target;
+  t_key handle;
+  int inserted;
+
+  // Definitions
+  p_table = p_context;
+  handle.p_key = p_entry->p_key;
+  handle.length = strlen(p_entry->p_key);
+  handle.hash = p_entry->hash;
+
+  if ((p_target = _locate(p_table, &handle, &inserted)) == NULL) {
+    return -1;
+  }
+
+  _assign(p_table, p_target, &handle, inserted, p_entry->p_value,
+    p_entry->expires);
+
+  return 0;
+}
+
+/**
+ * @brief The <code>ch_hash</code> function exposes the module's private string
+ * hashing function, <code>_hash</code>, to companion modules and callers that
+ * must agree with a <code>t_table</code> on the slot a given key occupies. The
+ * returned value has not yet been reduced modulo the number of table slots.
+ *
+ * @param p_key const char* The string to be hashed
+ * @return unsigned long int The resultant unreduced hash value
+ */
+unsigned long int ch_hash(const char * p_key) {
+  return _hash(p_key, strlen(p_key));
+}
+
+/**
+ * @brief The <code>ch_key</code> function builds a <code>t_key</code> handle
+ * for the string <code>p_key</code>, measuring and hashing it once. The handle
+ * refers to, rather than copies, the string, which must therefore outlive it.
+ * Handles may be passed to <code>ch_put_h</code>, <code>ch_get_h</code> and
+ * <code>ch_delete_h</code> any number of times and with any table, since the
+ * stored hash has not been reduced to a particular table's size.
+ *
+ * @param p_key const char* The string for which to build a handle
+ * @return t_key The handle, holding the string, its length and its hash
+ */
+t_key ch_key(const char * p_key) {
+
+  // Declaration
+  t_key handle;
+
+  // Definitions
+  handle.p_key = p_key;
+  handle.length = strlen(p_key);
+  handle.hash = _hash(p_key, handle.length);
+
+  return handle;
+}
+
+/**
+ * @brief The <code>ch_put</code> function maps the specified prop key denoted
+ * by the formal parameter <code>p_key</code> to the void pointer passed to the
+ * function as the associated value, namely, <code>p_value</code>. If an extant
+ * property is found at the specified key, the function assumes the intent is to
+ * update the value at that key, and <code>p_value</code> is mapped to the key.
+ * If two key/value pairs are mapped to the same hash slot, the function creates
+ * a linked list at that hash slot rather than lose the new pair or rehash and
+ * resize the entire structure. In a table with a capacity, a new key arriving
+ * when the table is full evicts the least recently used property. In a table
+ * with a budget, a write exceeding it either evicts or fails, as the table's
+ * policy dictates, and a write larger than the whole budget always fails; a
+ * failed write returns <code>NULL</code> and evicts nothing for the sake of
+ * the capacity.
+ * <br />
+ * <br />
+ * The author acknowledges that a rehash could be done here if multiple pairs
+ * are hashed to the same slot. However, if a table is too small, the same hash
+ * slot could be regenerated again, so a linked list is the safest approach. In
+ * large table sizes (or sizes as large as the total number of entries), a hash
+ * of two pairs to the same slot is unlikely, so the linked list is simply a
+ * fallback measure to gracefully handle edge cases without having to resize the
+ * entire structure accordingly.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return p_value void* A void pointer representing the value of the pair
+ */
+void * ch_put(t_table * p_table, const char * p_key, void * p_value) {
+
+  // Declaration
+  t_key handle;
+
+  // Definition
+  handle = ch_key(p_key);
+
+  return ch_put_h(p_table, &handle, p_value);
+}
+
+/**
+ * @brief The <code>ch_put_h</code> function behaves exactly as
+ * <code>ch_put</code>, save that the key is supplied as a <code>t_key</code>
+ * handle built beforehand by <code>ch_key</code>. The key string is thus not
+ * rehashed, and only the slot's list is walked.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_handle const t_key* The pre-hashed key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return p_value void* A void pointer representing the value of the pair
+ */
+void * ch_put_h(t_table * p_table, const t_key * p_handle, void * p_value) {
+
+  // Declarations
+  t_property * p_entry;
+  int inserted;
+
+  // Find the extant property for this key, or append a new one
+  if ((p_entry = _locate(p_table, p_handle, &inserted)) == NULL) {
+    return NULL;
+  }
+
+  // Either way, map the new value to the key, which no longer expires
+  return _assign(p_table, p_entry, p_handle, inserted, p_value, 0);
+}
+
+/**
+ * @brief The <code>ch_put_ttl</code> function behaves exactly as
+ * <code>ch_put</code>, save that the property expires <code>ttl</code>
+ * milliseconds from now on the monotonic clock. Once expired, the property is
+ * treated as absent by every function but <code>ch_delete</code>, and is
+ * dropped, with the table's <code>p_expire</code> function called on its key
+ * and value, by the first <code>ch_get</code> or <code>ch_expire_step</code>
+ * to come across it, or by a table with a capacity or budget making room. A
+ * <code>ttl</code> of 0 makes the property permanent, as does a later call to
+ * <code>ch_put</code> for the same key.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @param ttl unsigned long int Lifetime of the property in milliseconds
+ * @return p_value void* A void pointer representing the value of the pair
+ */
+void * ch_put_ttl(t_table * p_table, const char * p_key, void * p_value,
+    unsigned long int ttl) {
+
+  // Declarations
+  t_property * p_entry;
+  t_key handle;
+  int inserted;
+
+  // Definitions
+  handle = ch_key(p_key);
+
+  if ((p_entry = _locate(p_table, &handle, &inserted)) == NULL) {
+    return NULL;
+  }
+
+  return _assign(p_table, p_entry, &handle, inserted, p_value,
+    (ttl != 0) ? _now() + ttl : 0);
+}
+
+/**
+ * @brief The <code>ch_upsert</code> function combines <code>ch_get</code> and
+ * <code>ch_put</code> into a single walk of the slot's list. If a property is
+ * found at <code>p_key</code>, the address of its <code>p_value</code> data
+ * member is returned; otherwise a new property whose value is
+ * <code>NULL</code> is appended to the list and the address of its value is
+ * returned instead. The caller may read or write through the returned pointer
+ * to update the value in place, and the integer at <code>p_inserted</code>, if
+ * provided, is set to denote which of the two cases occurred. The pointer
+ * remains valid until the property is deleted, evicted or dropped on expiry,
+ * or the table is cleared or compacted with <code>ch_compact</code>, which
+ * moves every property. Taking a snapshot with <code>ch_snapshot</code>
+ * likewise invalidates every pointer obtained beforehand, as the first write
+ * to a slot the snapshot shares moves the slot's properties into copies; a
+ * write through an old pointer would then alter the snapshot and be lost to
+ * the table. Call <code>ch_upsert</code> again after taking a snapshot, as
+ * it returns the address within the table's own copy. Values written through
+ * the pointer are not charged against a table's budget until next stored with
+ * <code>ch_put</code>.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_inserted int* Set to 1 if the property was created, else 0
+ * @return void** Address of the property's value, or <code>NULL</code>
+ */
+void ** ch_upsert(t_table * p_table, const char * p_key, int * p_inserted) {
+
+  // Declarations
+  t_property * p_entry;
+  t_key handle;
+  int inserted;
+
+  // Definitions
+  handle = ch_key(p_key);
+  p_entry = _locate(p_table, &handle, &inserted);
+
+  // Charge a new property for its key, refusing it if over budget
+  if (p_entry != NULL && inserted && !_charge(p_table, p_entry,
+      handle.length)) {
+    _unlink(p_table, p_entry);
+    _clear(p_table, p_entry);
+    p_entry = NULL;
+  }
+
+  if (p_inserted != NULL) {
+    *p_inserted = inserted;
+  }
+
+  return (p_entry != NULL) ? &p_entry->p_value : NULL;
+}
+
+/**
+ * @brief The <code>ch_get</code> function is used to retrieve the void pointer
+ * constituting the value of the <code>t_property</code> type that is associated
+ * with the formal parameter <code>p_key</code>. If multiple pairs exist at the
+ * same hash slot, the function will iterate along the list until a match is
+ * found or the end of the list encountered. The function does not remove the
+ * key/value pair; that is the purpose of the <code>delete</code> function.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_get(t_table * p_table, const char * p_key) {
+
+  // Declaration
+  t_key handle;
+
+  // Definition
+  handle = ch_key(p_key);
+
+  return ch_get_h(p_table, &handle);
+}
+
+/**
+ * @brief The <code>ch_get_h</code> function behaves exactly as
+ * <code>ch_get</code>, save that the key is supplied as a <code>t_key</code>
+ * handle built beforehand by <code>ch_key</code>. As each property caches the
+ * hash of its key, properties in the slot's list whose hashes differ from the
+ * handle's are passed over without their key strings being compared. If the
+ * table's <code>flags</code> include <code>CH_MOVE_TO_FRONT</code>, a property
+ * found further down the list is moved to its head, so that frequently read
+ * keys settle at the front of their slots and are found after a single
+ * comparison. An expired property is dropped rather than returned, as
+ * described for <code>ch_put_ttl</code>. In a table with a capacity, the
+ * property found becomes the most recently used.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_handle const t_key* The pre-hashed key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_get_h(t_table * p_table, const t_key * p_handle) {
+
+  // Declarations
+  unsigned long int hash;
+  t_property * p_entry, * p_previous;
+
+  // Ensure hash lies between 0 and table's size
+  hash = p_handle->hash % p_table->size;
+
+  // Get prospective key/value pair
+  p_entry = p_table->p_entries[hash];
+  p_previous = NULL;
+
+  if (p_entry == NULL) {
+    return NULL;
+  }
+
+  // Iterate through potential linked list found at hash slot
+  while (p_entry != NULL) {
+
+    // Return match found in linked list
+    if (p_entry->hash == p_handle->hash &&
+        strcmp(p_entry->p_key, p_handle->p_key) == 0) {
+
+      // Drop an expired match, unless a snapshot shares it, and report the
+      // key absent
+      if (p_entry->expires != 0 && p_entry->expires <= _now()) {
+        if (!_shared(p_table, hash)) {
+          _drop(p_table, (p_previous == NULL) ? &p_table->p_entries[hash]
+            : &p_previous->p_next);
+          _shrink(p_table);
+        }
+
+        return NULL;
+      }
+
+      // Promote the match to the head of the list in adaptive mode
+      if (p_previous != NULL && (p_table->flags & CH_MOVE_TO_FRONT) &&
+          !_shared(p_table, hash)) {
+        p_previous->p_next = p_entry->p_next;
+        p_entry->p_next = p_table->p_entries[hash];
+        p_table->p_entries[hash] = p_entry;
+      }
+
+      _touch(p_table, p_entry);
+      return p_entry->p_value;
+    }
+
+    p_previous = p_entry;
+    p_entry = p_entry->p_next;
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief The <code>ch_delete</code> function is used to remove the property
+ * specified via the parameter constituting the key, namely <code>p_key</code>.
+ * If multiple pairs exist at the same hash slot, the function will iterate
+ * along the list until a match is found or the end of the list encountered.
+ * Though the function returns the void pointer constituting the value, it
+ * should not be used as the retrieval function; that is the purpose of the
+ * <code>ch_get</code> function.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_delete(t_table * p_table, const char * p_key) {
+
+  // Declaration
+  t_key handle;
+
+  // Definition
+  handle = ch_key(p_key);
+
+  return ch_delete_h(p_table, &handle);
+}
+
+/**
+ * @brief The <code>ch_delete_h</code> function behaves exactly as
+ * <code>ch_delete</code>, save that the key is supplied as a
+ * <code>t_key</code> handle built beforehand by <code>ch_key</code>.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_handle const t_key* The pre-hashed key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_delete_h(t_table * p_table, const t_key * p_handle) {
+
+  // Declarations
+  unsigned long int hash;
+  t_property * p_current, * p_previous;
+  void * p_value_storage;
+
+  // Ensure hash lies between 0 and table's max size
+  hash = p_handle->hash % p_table->size;
+
+  // Get first prospective key/value pair at slot
+  p_current = p_table->p_entries[hash];
+  p_previous = NULL;
+
+  // Iterate through potential linked list comparing key strings
+  while (p_current != NULL && (p_current->hash != p_handle->hash ||
+      strcmp(p_current->p_key, p_handle->p_key) != 0)) {
+    p_previous = p_current;
+    p_current = p_current->p_next;
+  }
+
+  // No such key/value pair found matching target
+  if (p_current == NULL) {
+    return NULL;
+  }
+
+  // Copy a list shared with a snapshot, then find the key in the copy
+  if (_shared(p_table, hash)) {
+    return (_own(p_table, hash) == 0) ? ch_delete_h(p_table, p_handle) : NULL;
+  }
+
+  // Store value void pointer for return from function
+  p_value_storage = p_current->p_value;
+
+  /*
+   * If there is no previous entry prior to target entry, redefine "head node"
+   * sitting at this hash slot. Otherwise, redefine the previous node's p_next
+   * data member. If the current node has no next property, implying it sits at
+   * the end of the linked list, apply NULL as the redefined value. Otherwise,
+   * set the next node as the redefined value.
+   */
+  *((!p_previous) ? &p_table->p_entries[hash] : &p_previous->p_next) =
+    (!p_current->p_next) ? NULL : p_current->p_next;
+
+  // Deallocate space reserved for this property
+  _forget(p_table, p_current);
+  _clear(p_table, p_current);
+  _shrink(p_table);
+
+  // Return cached value void pointer
+  return p_value_storage;
+}
+
+/**
+ * @brief The <code>ch_expire_step</code> function performs a bounded amount of
+ * expiry work, so that expired properties which are never looked up again are
+ * still reclaimed without the table being swept in one long pass. Each call
+ * walks the lists of at most <code>budget</code> slots, resuming at the slot
+ * where the previous call stopped and wrapping around at the end of the table,
+ * and drops every expired property found as <code>ch_get</code> would.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param budget unsigned long int Maximum number of slots to examine
+ * @return unsigned long int Number of properties dropped
+ */
+unsigned long int ch_expire_step(t_table * p_table, unsigned long int budget) {
+
+  // Declarations
+  unsigned long int now, dropped;
+  t_property ** p_link;
+
+  // Definitions
+  now = _now();
+  dropped = 0;
+
+  // Visiting a slot twice in one call would find nothing new
+  if (budget > p_table->size) {
+    budget = p_table->size;
+  }
+
+  while (budget-- > 0) {
+    p_link = &p_table->p_entries[p_table->cursor];
+
+    // Copy a list shared with a snapshot only if it holds expired properties
+    if (_shared(p_table, p_table->cursor)) {
+      while (*p_link != NULL && ((*p_link)->expires == 0 ||
+          (*p_link)->expires > now)) {
+        p_link = &(*p_link)->p_next;
+      }
+
+      if (*p_link == NULL || _own(p_table, p_table->cursor) != 0) {
+        p_table->cursor = (p_table->cursor + 1) % p_table->size;
+        continue;
+      }
+
+      p_link = &p_table->p_entries[p_table->cursor];
+    }
+
+    while (*p_link != NULL) {
+      if ((*p_link)->expires != 0 && (*p_link)->expires <= now) {
+        _drop(p_table, p_link);
+        dropped++;
+      } else {
+        p_link = &(*p_link)->p_next;
+      }
+    }
+
+    p_table->cursor = (p_table->cursor + 1) % p_table->size;
+  }
+
+  _shrink(p_table);
+
+  return dropped;
+}
+
+/**
+ * @brief The <code>ch_reserve</code> function prepares <code>p_table</code>
+ * for <code>count</code> more properties ahead of a bulk load. The slot array
+ * is first grown, if need be, to at least one slot per property expected, and
+ * a single block is then allocated holding enough properties, along with key
+ * storage for identifiers of typical length, to make up any shortfall in the
+ * table's spares. Until it is used up, new keys take no allocation and cause
+ * no rehashing. Reserved memory is not charged against a budget until used,
+ * and is released only when the table is destroyed.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param count unsigned long int Number of properties about to be added
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int ch_reserve(t_table * p_table, unsigned long int count) {
+
+  // Declaration
+  unsigned long int needed;
+
+  // Grow the slots first, so that the load stays at or below one per slot
+  if (p_table->count + count > p_table->size &&
+      _resize(p_table, p_table->count + count) != 0) {
+    return -1;
+  }
+
+  if (count <= p_table->spares) {
+    return 0;
+  }
+
+  // Definition
+  needed = count - p_table->spares;
+
+  return _reserve(p_table, needed, CH_RESERVE_KEY * needed);
+}
+
+/**
+ * @brief The <code>ch_compact</code> function rebuilds <code>p_table</code>
+ * after heavy churn. The slot array is replaced by one sized to the number of
+ * properties, though no smaller than the table's minimum, and every property
+ * and key is copied, slot by slot, into a single block allocated for the
+ * purpose, so that each list is laid out contiguously rather than scattered
+ * over the blocks freed since the table was filled. The properties copied are
+ * then freed, as is any memory set aside by <code>ch_reserve</code>, whether
+ * used or not, so pointers returned by <code>ch_upsert</code> no longer hold.
+ * Should any allocation fail, or a snapshot of the table be live, the table is
+ * left as it was.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @return int 0 on success, -1 if the table could not be compacted
+ */
+int ch_compact(t_table * p_table) {
+
+  // Declarations
+  t_property ** p_entries, ** p_link, * p_entry, * p_copy, * p_next;
+  t_property * p_originals;
+  t_reserve * p_reserve, * p_reserves;
+  unsigned long int size, mapped, counter, key_bytes;
+  unsigned int pages;
+  t_key handle;
+
+  // Lists shared with a snapshot must not be moved
+  if (p_table->p_snapshot != NULL) {
+    return -1;
+  }
+
+  // Definitions
+  size = (p_table->count > p_table->minimum) ? p_table->count
+    : p_table->minimum;
+  mapped = p_table->mapped;
+  pages = p_table->pages;
+  p_reserves = p_table->p_reserves;
+  key_bytes = 0;
+
+  // Growth beyond the budget is refused, as it is when resizing
+  if (p_table->budget != 0 && size > p_table->size && p_table->bytes +
+      sizeof(t_property *) * (size - p_table->size) > p_table->budget) {
+    size = p_table->size;
+  }
+
+  for (counter = 0; counter < p_table->size; counter++) {
+    for (p_entry = p_table->p_entries[counter]; p_entry != NULL;
+        p_entry = p_entry->p_next) {
+      key_bytes += strlen(p_entry->p_key) + 1;
+    }
+  }
+
+  if ((p_entries = _slots(p_table, size, mapped != 0)) == NULL) {
+    p_table->mapped = mapped;
+    p_table->pages = pages;
+    return -1;
+  }
+
+  // Set aside one block for every copy, from which none can fail to be made
+  if (p_table->count != 0 && _reserve(p_table, p_table->count, key_bytes) !=
+      0) {
+    _unslot(p_table, p_entries, p_table->mapped);
+    p_table->mapped = mapped;
+    p_table->pages = pages;
+    return -1;
+  }
+
+  // Move the originals into the new array, each list keeping its order
+  for (counter = 0; counter < p_table->size; counter++) {
+    for (p_entry = p_table->p_entries[counter]; p_entry != NULL;
+        p_entry = p_next) {
+      p_next = p_entry->p_next;
+      _append(p_entries, p_entry->hash % size, p_entry);
+    }
+  }
+
+  _seal(p_entries, size);
+  p_originals = NULL;
+
+  /*
+   * Replace each list with copies carved in the new array's slot order, and
+   * set the originals aside in a list of their own. Each original's value is
+   * replaced by its copy, which already holds the value, to forward the
+   * recency links below.
+   */
+  for (counter = 0; counter < size; counter++) {
+    p_link = &p_entries[counter];
+
+    for (p_entry = *p_link; p_entry != NULL; p_entry = p_next) {
+      p_next = p_entry->p_next;
+      handle.p_key = p_entry->p_key;
+      handle.length = strlen(p_entry->p_key);
+      handle.hash = p_entry->hash;
+
+      p_copy = _construct(p_table, &handle, p_entry->p_value);
+      p_copy->expires = p_entry->expires;
+      p_copy->bytes = p_entry->bytes;
+      p_copy->p_newer = p_entry->p_newer;
+      p_copy->p_older = p_entry->p_older;
+
+      *p_link = p_copy;
+      p_link = &p_copy->p_next;
+      p_entry->p_value = p_copy;
+      p_entry->p_next = p_originals;
+      p_originals = p_entry;
+    }
+  }
+
+  // Point the recency list at the copies while the originals still exist
+  if (p_table->capacity != 0 || p_table->budget != 0) {
+    for (counter = 0; counter < size; counter++) {
+      for (p_copy = p_entries[counter]; p_copy != NULL;
+          p_copy = p_copy->p_next) {
+        if (p_copy->p_newer != NULL) {
+          p_copy->p_newer = p_copy->p_newer->p_value;
+        }
+
+        if (p_copy->p_older != NULL) {
+          p_copy->p_older = p_copy->p_older->p_value;
+        }
+      }
+    }
+
+    if (p_table->p_newest != NULL) {
+      p_table->p_newest = p_table->p_newest->p_value;
+      p_table->p_oldest = p_table->p_oldest->p_value;
+    }
+  }
+
+  for (p_entry = p_originals; p_entry != NULL; p_entry = p_next) {
+    p_next = p_entry->p_next;
+    _clear(p_table, p_entry);
+  }
+
+  // No property is left in any earlier block, so they may all be freed once
+  // the spares, every one of which is now either in them or singly allocated,
+  // are gone
+  _spill(p_table);
+
+  if (p_table->count != 0) {
+    p_reserve = p_table->p_reserves;
+    p_reserves = p_reserve->p_next;
+    p_reserve->p_next = NULL;
+  } else {
+    p_table->p_reserves = NULL;
+    p_table->p_key_cursor = NULL;
+    p_table->p_key_limit = NULL;
+  }
+
+  while ((p_reserve = p_reserves) != NULL) {
+    p_reserves = p_reserve->p_next;
+    p_table->allocator.p_free(p_reserve, p_table->allocator.p_context);
+  }
+
+  _unslot(p_table, p_table->p_entries, mapped);
+  p_table->bytes = p_table->bytes - sizeof(t_property *) * p_table->size +
+    sizeof(t_property *) * size;
+  p_table->p_entries = p_entries;
+  p_table->size = size;
+  p_table->cursor %= size;
+
+  return 0;
+}
+
+/**
+ * @brief The <code>ch_clone</code> function constructs a deep copy of
+ * <code>p_table</code>, with the same size, settings, flags and hooks. The
+ * properties and keys of the copy are laid out in a single block, allocated
+ * once and filled slot by slot, and each copy keeps its original's cached
+ * hash and expiry, so no key is rehashed. In a table with a capacity or
+ * budget, the copy's properties are ordered by recency as the originals are.
+ * The values themselves are shared.
  *
- * @see http://www.cse.yorku.ca/~oz/hash.html
- * @param p_key const char* The string to be hashed
- * @return value unsigned long int The resultant hash <code>int</code> value
+ * @param p_table t_table* A pointer to the hash table to be copied
+ * @return t_table* A pointer to the copy, or <code>NULL</code>
  */
-static unsigned long int _hash(const char * p_key) {
+t_table * ch_clone(t_table * p_table) {
 
   // Declarations
-  unsigned int counter;
-  unsigned short length;
-  unsigned long int value;
+  t_options options;
+  t_table * p_clone;
+  t_property * p_entry, * p_copy, ** p_tail;
+  unsigned long int counter, key_bytes;
+  t_key handle;
+  int ordered;
 
-  // Definitions
-  length = strlen(p_key);
-  value = 0L;
+  // Carry every setting over to the copy
+  memset(&options, 0, sizeof(options));
+  options.capacity = p_table->capacity;
+  options.p_evict = p_table->p_evict;
+  options.budget = p_table->budget;
+  options.policy = p_table->policy;
+  options.p_size = p_table->p_size;
+  options.p_allocator = &p_table->allocator;
+  options.huge_pages = p_table->mapped != 0;
+  options.low_watermark = p_table->low_watermark;
+  options.min_size = p_table->minimum;
+
+  if ((p_clone = ch_create_ex(p_table->size, &options)) == NULL) {
+    return NULL;
+  }
+
+  p_clone->flags = p_table->flags;
+  p_clone->p_expire = p_table->p_expire;
+  key_bytes = 0;
+
+  // Size one block to hold every property and key
+  for (counter = 0; counter < p_table->size; counter++) {
+    for (p_entry = p_table->p_entries[counter]; p_entry != NULL;
+        p_entry = p_entry->p_next) {
+      key_bytes += strlen(p_entry->p_key) + 1;
+    }
+  }
+
+  if (p_table->count != 0 && _reserve(p_clone, p_table->count, key_bytes) !=
+      0) {
+    ch_destroy(p_clone);
+    return NULL;
+  }
+
+  /*
+   * Visit the originals from least to most recently used if the table keeps
+   * them in that order, so that touching each copy rebuilds the order, and
+   * otherwise slot by slot, appending each copy at its slot's tail.
+   */
+  ordered = p_table->capacity != 0 || p_table->budget != 0;
+  p_entry = ordered ? p_table->p_oldest : NULL;
   counter = 0;
+  p_tail = &p_clone->p_entries[0];
 
-  // Update value based on previous value, string length, and ASCII value
-  while (counter < length) {
-    value = value * 33 + p_key[counter++];
+  while (p_entry != NULL || (!ordered && counter < p_table->size)) {
+    if (p_entry == NULL) {
+      p_tail = &p_clone->p_entries[counter];
+      p_entry = p_table->p_entries[counter++];
+      continue;
+    }
+
+    handle.p_key = p_entry->p_key;
+    handle.length = strlen(p_entry->p_key);
+    handle.hash = p_entry->hash;
+
+    if ((p_copy = _construct(p_clone, &handle, p_entry->p_value)) == NULL) {
+      ch_destroy(p_clone);
+      return NULL;
+    }
+
+    p_copy->expires = p_entry->expires;
+    p_copy->bytes = p_entry->bytes;
+    p_clone->count++;
+
+    if (ordered) {
+      for (p_tail = &p_clone->p_entries[p_entry->hash % p_clone->size];
+          *p_tail != NULL; p_tail = &(*p_tail)->p_next);
+
+      _touch(p_clone, p_copy);
+      p_entry = p_entry->p_newer;
+    } else {
+      p_entry = p_entry->p_next;
+    }
+
+    *p_tail = p_copy;
+    p_tail = &p_copy->p_next;
   }
 
-  return value;
+  p_clone->bytes = p_table->bytes;
+
+  return p_clone;
 }
 
 /**
- * @brief The <code>_clear</code> helper function is a private function that is
- * used to deallocate all space previously reserved in heap memory for a
- * <code>t_property</code> <code>struct</code> and its associated string data
- * member <code>p_key</code>. This function is used by the public functions
- * <code>ch_clear</code> and <code>ch_destroy</code> to clean out an extant hash
- * table as needed.
+ * @brief The <code>ch_merge</code> function writes every property of
+ * <code>p_source</code> into <code>p_table</code>. Where a key is present in
+ * both, <code>policy</code> decides the outcome: <code>CH_MERGE_REPLACE</code>
+ * takes the source's value and expiry, <code>CH_MERGE_KEEP</code> leaves the
+ * destination's. The source keys absent from the destination are counted
+ * first, and the destination is presized once with properties and key storage
+ * for at least those keys, drawing on any left from earlier reservations, so
+ * that repeatedly merging overlapping tables reserves memory only for keys
+ * actually added. A new block is reserved only if the key storage left is too
+ * small, and is then given room for keys of typical length; otherwise any
+ * shortfall of spares is made up by single allocations.
+ * Each key is placed by its cached hash rather than being rehashed. Expired
+ * source properties are skipped.
  *
- * @param p_entry t_property* The specific <code>t_property</code> to be cleared
- * @return void
+ * @param p_table t_table* A pointer to the destination hash table
+ * @param p_source t_table* A pointer to the source hash table, left unchanged
+ * @param policy unsigned int <code>CH_MERGE_REPLACE</code> or
+ * <code>CH_MERGE_KEEP</code>
+ * @return int 0 on success, -1 if the policy is unknown or a write failed, in
+ * which case the keys merged before it remain
  */
-static void _clear(t_property * p_entry) {
+int ch_merge(t_table * p_table, t_table * p_source, unsigned int policy) {
 
-  // Free key space if extant
-  if (p_entry->p_key != NULL) {
-    free(p_entry->p_key);
-    p_entry->p_key = NULL;
+  // Declarations
+  t_property * p_entry, * p_target;
+  unsigned long int counter, now, missing, key_bytes;
+  t_key handle;
+  int inserted;
+
+  if (p_table == p_source || (policy != CH_MERGE_REPLACE &&
+      policy != CH_MERGE_KEEP)) {
+    return -1;
   }
 
-  // Free entry itself if extant
-  if (p_entry != NULL) {
-    free(p_entry);
-    p_entry = NULL;
+  // Definitions
+  now = _now();
+  missing = 0;
+  key_bytes = 0;
+
+  // Count the keys to be added, as only they need properties and key storage
+  for (counter = 0; counter < p_source->size; counter++) {
+    for (p_entry = p_source->p_entries[counter]; p_entry != NULL;
+        p_entry = p_entry->p_next) {
+      if ((p_entry->expires == 0 || p_entry->expires > now) &&
+          !_member(p_table, p_entry->hash % p_table->size, p_entry, now)) {
+        missing++;
+        key_bytes += strlen(p_entry->p_key) + 1;
+      }
+    }
+  }
+
+  // Presizing only saves work, so the merge goes ahead if it fails
+  if (p_table->count + missing > p_table->size) {
+    _resize(p_table, p_table->count + missing);
+  }
+
+  // A new block is needed only if the key storage left falls short, and is
+  // given room for keys of typical length so later merges may share it
+  if (key_bytes > (unsigned long int) (p_table->p_key_limit -
+      p_table->p_key_cursor)) {
+    _reserve(p_table, (missing > p_table->spares) ? missing -
+      p_table->spares : 0, (key_bytes > CH_RESERVE_KEY * missing) ? key_bytes
+      : CH_RESERVE_KEY * missing);
+  } else if (missing > p_table->spares) {
+    _top_up(p_table, missing - p_table->spares);
+  }
+
+  for (counter = 0; counter < p_source->size; counter++) {
+    for (p_entry = p_source->p_entries[counter]; p_entry != NULL;
+        p_entry = p_entry->p_next) {
+      if (p_entry->expires != 0 && p_entry->expires <= now) {
+        continue;
+      }
+
+      handle.p_key = p_entry->p_key;
+      handle.length = strlen(p_entry->p_key);
+      handle.hash = p_entry->hash;
+
+      if ((p_target = _locate(p_table, &handle, &inserted)) == NULL) {
+        return -1;
+      }
+
+      if (!inserted && policy == CH_MERGE_KEEP) {
+        continue;
+      }
+
+      if (_assign(p_table, p_target, &handle, inserted, p_entry->p_value,
+          p_entry->expires) == NULL && p_entry->p_value != NULL) {
+        return -1;
+      }
+    }
   }
+
+  return 0;
 }
 
 /**
- * @brief The <code>_construct</code> helper function is a private function that
- * is used to build a <code>t_property</code> <code>struct</code> from the key
- * and value passed as formal parameters. It allocates space in memory for the
- * new object and the string key, sets the various members, and returns the
- * <code>struct</code> for inclusion in the hash table. It is invoked primarily
- * by <code>ch_put</code> to assign new properties.
+ * @brief The <code>ch_set</code> function constructs a table holding the
+ * result of <code>operation</code> on the keys of <code>p_left</code> and
+ * <code>p_right</code>: <code>CH_SET_UNION</code>,
+ * <code>CH_SET_INTERSECTION</code> or <code>CH_SET_DIFFERENCE</code>, the
+ * last being the keys of <code>p_left</code> absent from
+ * <code>p_right</code>. Keys are tested and placed by their cached hashes, so
+ * none is rehashed, and each takes its value and expiry from
+ * <code>p_left</code> if present there. The new table uses
+ * <code>p_left</code>'s allocator and has a slot for every key the result
+ * could hold. Expired properties count as absent.
  *
- * @param p_key const char* A string representing the key of the key/value pair
- * @param p_value void* A void pointer to the address of the associated value
- * @return t_property*
+ * @param p_left t_table* A pointer to the left operand
+ * @param p_right t_table* A pointer to the right operand
+ * @param operation unsigned int One of the <code>CH_SET_*</code> operations
+ * @return t_table* A pointer to the resultant table, or <code>NULL</code>
  */
-static t_property * _construct(const char * p_key, void * p_value) {
+t_table * ch_set(t_table * p_left, t_table * p_right, unsigned int operation) {
 
-  // Declaration
-  t_property * p_entry;
+  // Declarations
+  t_options options;
+  t_table * p_table;
+  unsigned long int bound;
 
-  // Allocation definitions
-  p_entry = malloc(sizeof(t_property));
-  p_entry->p_key = malloc(strlen(p_key) + 1);
+  if (operation > CH_SET_DIFFERENCE) {
+    return NULL;
+  }
 
-  // Ensure space was successfully allocated for both
-  if (!p_entry || !p_entry->p_key) {
-    _clear(p_entry);
+  // Size the result for its largest possible count
+  bound = (operation == CH_SET_UNION) ? p_left->count + p_right->count
+    : (operation == CH_SET_INTERSECTION && p_right->count < p_left->count)
+    ? p_right->count : p_left->count;
+
+  memset(&options, 0, sizeof(options));
+  options.p_allocator = &p_left->allocator;
+
+  if ((p_table = ch_create_ex((bound != 0) ? bound : 1, &options)) == NULL) {
     return NULL;
   }
 
-  // Copy string to data member from formal parameter
-  strcpy(p_entry->p_key, p_key);
+  if (_combine(p_left, p_right, operation, 0, 1, _gather, p_table) != 0) {
+    ch_destroy(p_table);
+    return NULL;
+  }
 
-  // Set value as formal parameter void pointer
-  p_entry->p_value = p_value;
+  return p_table;
+}
 
-  // No next by default
-  p_entry->p_next = NULL;
+/**
+ * @brief The <code>ch_set_each</code> function streams the result of
+ * <code>operation</code>, as computed by <code>ch_set</code>, to
+ * <code>p_visit</code> rather than building a table, calling it with each key,
+ * its value and <code>p_context</code>. Only partition <code>part</code> of
+ * <code>parts</code> is computed: each operand's slots are split into
+ * <code>parts</code> ranges of near equal length, and every key of the result
+ * falls in exactly one partition. As the tables are only read, each partition
+ * may be computed by its own thread, provided that neither table is written
+ * meanwhile.
+ *
+ * @param p_left t_table* A pointer to the left operand
+ * @param p_right t_table* A pointer to the right operand
+ * @param operation unsigned int One of the <code>CH_SET_*</code> operations
+ * @param part unsigned long int The partition to compute, below
+ * <code>parts</code>
+ * @param parts unsigned long int Number of partitions, 1 for the whole result
+ * @param p_visit void (*)(const char*, void*, void*) Receives each key/value
+ * pair
+ * @param p_context void* State passed to <code>p_visit</code>
+ * @return int 0 on success, -1 if the operation or partition is invalid
+ */
+int ch_set_each(t_table * p_left, t_table * p_right, unsigned int operation,
+    unsigned long int part, unsigned long int parts,
+    void (* p_visit)(const char * p_key, void * p_value, void * p_context),
+    void * p_context) {
 
-  return p_entry;
+  // Declaration
+  t_stream stream;
+
+  if (operation > CH_SET_DIFFERENCE || part >= parts) {
+    return -1;
+  }
+
+  // Definitions
+  stream.p_visit = p_visit;
+  stream.p_context = p_context;
+
+  return _combine(p_left, p_right, operation, part, parts, _stream, &stream);
 }
 
 /**
- * @brief The <code>ch_put</code> function maps the specified prop key denoted
- * by the formal parameter <code>p_key</code> to the void pointer passed to the
- * function as the associated value, namely, <code>p_value</code>. If an extant
- * property is found at the specified key, the function assumes the intent is to
- * update the value at that key, and <code>p_value</code> is mapped to the key.
- * If two key/value pairs are mapped to the same hash slot, the function creates
- * a linked list at that hash slot rather than lose the new pair or rehash and
- * resize the entire structure.
+ * @brief The <code>ch_snapshot</code> function takes an immutable view of
+ * <code>p_table</code> as it stands. Only the slot array is copied; every list
+ * is shared with the table until the table next writes to its slot, when the
+ * table copies the list for itself and leaves the original to the snapshot.
+ * The table's writer may thus carry on while other threads read the snapshot
+ * through <code>ch_snapshot_get</code>, as nothing the snapshot can reach is
+ * ever modified. While a snapshot is live, the table does not resize, and a
+ * read neither moves nor drops a property in a shared list. Because a write
+ * moves a shared list's properties into copies, every pointer returned by
+ * <code>ch_upsert</code> before the snapshot was taken must be discarded:
+ * writing through one would modify the snapshot rather than the table.
  * <br />
  * <br />
- * The author acknowledges that a rehash could be done here if multiple pairs
- * are hashed to the same slot. However, if a table is too small, the same hash
- * slot could be regenerated again, so a linked list is the safest approach. In
- * large table sizes (or sizes as large as the total number of entries), a hash
- * of two pairs to the same slot is unlikely, so the linked list is simply a
- * fallback measure to gracefully handle edge cases without having to resize the
- * entire structure accordingly.
+ * One snapshot may be live per table. Tables with a capacity, a budget or the
+ * <code>CH_MOVE_TO_FRONT</code> flag, whose lookups reorder properties, cannot
+ * be snapshotted.
  *
  * @param p_table t_table* A pointer to the specific hash table
- * @param p_key const char* A string representing the key of the key/value pair
- * @param p_value void* A void pointer to the address of the associated value
- * @return p_value void* A void pointer representing the value of the pair
+ * @return t_snapshot* The snapshot, or <code>NULL</code> if none can be taken
  */
-void * ch_put(t_table * p_table, const char * p_key, void * p_value) {
-
-  // Declarations
-  unsigned int hash;
-  t_property * p_entry, * p_previous;
-
-  // Ensure hash lies between 0 and table's max size
-  hash = _hash(p_key) % p_table->size;
+t_snapshot * ch_snapshot(t_table * p_table) {
 
-  // Get first prospective key/value pair at this slot
-  p_entry = p_table->p_entries[hash];
+  // Declaration
+  t_snapshot * p_snapshot;
 
-  // If there's nothing at this slot, add a new property struct here
-  if (p_entry == NULL) {
-    p_table->p_entries[hash] = _construct(p_key, p_value);
-    return p_value;
+  if (p_table->p_snapshot != NULL || p_table->capacity != 0 ||
+      p_table->budget != 0 || (p_table->flags & CH_MOVE_TO_FRONT)) {
+    return NULL;
   }
 
-  // If there already are entries at this slot...
-  while (p_entry != NULL) {
-
-    // Update value of match found in linked list
-    if (strcmp(p_entry->p_key, p_key) == 0) {
-      p_entry->p_value = p_value;
-      return p_value;
-    }
+  if ((p_snapshot = p_table->allocator.p_malloc(sizeof(t_snapshot),
+      p_table->allocator.p_context)) == NULL) {
+    return NULL;
+  }
 
-    p_previous = p_entry;
-    p_entry = p_previous->p_next;
+  if ((p_snapshot->p_entries = p_table->allocator.p_malloc(
+      sizeof(t_property *) * p_table->size, p_table->allocator.p_context)) ==
+      NULL) {
+    p_table->allocator.p_free(p_snapshot, p_table->allocator.p_context);
+    return NULL;
   }
 
-  // Add new property at tail of linked list
-  p_previous->p_next = _construct(p_key, p_value);
-  return p_value;
+  memcpy(p_snapshot->p_entries, p_table->p_entries, sizeof(t_property *) *
+    p_table->size);
+  p_snapshot->size = p_table->size;
+  p_snapshot->count = p_table->count;
+  p_table->p_snapshot = p_snapshot;
+
+  return p_snapshot;
 }
 
 /**
- * @brief The <code>ch_get</code> function is used to retrieve the void pointer
- * constituting the value of the <code>t_property</code> type that is associated
- * with the formal parameter <code>p_key</code>. If multiple pairs exist at the
- * same hash slot, the function will iterate along the list until a match is
- * found or the end of the list encountered. The function does not remove the
- * key/value pair; that is the purpose of the <code>delete</code> function.
+ * @brief The <code>ch_snapshot_get</code> function retrieves the value that
+ * was mapped to <code>p_key</code> when <code>p_snapshot</code> was taken. A
+ * property that has since expired is reported absent. The snapshot is never
+ * modified, so any number of threads may call this function at once.
  *
- * @param p_table t_table* A pointer to the specific hash table
+ * @param p_snapshot const t_snapshot* A pointer to the snapshot
  * @param p_key const char* A string representing the key of the desired value
  * @return void* A void pointer representing the value of the key/value pair
  */
-void * ch_get(t_table * p_table, const char * p_key) {
+void * ch_snapshot_get(const t_snapshot * p_snapshot, const char * p_key) {
 
   // Declarations
-  unsigned int hash;
+  unsigned long int hash;
   t_property * p_entry;
 
-  // Ensure hash lies between 0 and table's size
-  hash = _hash(p_key) % p_table->size;
-
-  // Get prospective key/value pair
-  p_entry = p_table->p_entries[hash];
-
-  if (p_entry == NULL) {
-    return NULL;
-  }
+  // Definition
+  hash = _hash(p_key, strlen(p_key));
 
-  // Iterate through potential linked list found at hash slot
-  while (p_entry != NULL) {
-
-    // Return match found in linked list
-    if (strcmp(p_entry->p_key, p_key) == 0) {
-      return p_entry->p_value;
+  for (p_entry = p_snapshot->p_entries[hash % p_snapshot->size];
+      p_entry != NULL; p_entry = p_entry->p_next) {
+    if (p_entry->hash == hash && strcmp(p_entry->p_key, p_key) == 0) {
+      return (p_entry->expires != 0 && p_entry->expires <= _now()) ? NULL
+        : p_entry->p_value;
     }
-
-    p_entry = p_entry->p_next;
   }
 
   return NULL;
 }
 
 /**
- * @brief The <code>ch_delete</code> function is used to remove the property
- * specified via the parameter constituting the key, namely <code>p_key</code>.
- * If multiple pairs exist at the same hash slot, the function will iterate
- * along the list until a match is found or the end of the list encountered.
- * Though the function returns the void pointer constituting the value, it
- * should not be used as the retrieval function; that is the purpose of the
- * <code>ch_get</code> function.
+ * @brief The <code>ch_snapshot_release</code> function releases
+ * <code>p_snapshot</code>, which must have been taken of
+ * <code>p_table</code>, freeing every list the table has since replaced and
+ * allowing the table to resize again. A snapshot must be released before its
+ * table is destroyed, and only once no thread is reading it.
  *
  * @param p_table t_table* A pointer to the specific hash table
- * @param p_key const char* A string representing the key of the desired value
- * @return void* A void pointer representing the value of the key/value pair
+ * @param p_snapshot t_snapshot* A pointer to the snapshot
+ * @return void
  */
-void * ch_delete(t_table * p_table, const char * p_key) {
+void ch_snapshot_release(t_table * p_table, t_snapshot * p_snapshot) {
 
   // Declarations
-  unsigned int hash;
-  t_property * p_current, * p_previous;
-  void * p_value_storage;
-
-  // Ensure hash lies between 0 and table's max size
-  hash = _hash(p_key) % p_table->size;
-
-  // Get first prospective key/value pair at slot
-  p_current = p_table->p_entries[hash];
-  p_previous = NULL;
+  t_property * p_entry, * p_next;
+  unsigned long int counter;
 
-  // Iterate through potential linked list comparing key strings
-  while (p_current != NULL && strcmp(p_current->p_key, p_key) != 0) {
-    p_previous = p_current;
-    p_current = p_current->p_next;
-  }
+  for (counter = 0; counter < p_snapshot->size; counter++) {
+    if (p_snapshot->p_entries[counter] == p_table->p_entries[counter]) {
+      continue;
+    }
 
-  // No such key/value pair found matching target
-  if (p_current == NULL) {
-    return NULL;
+    for (p_entry = p_snapshot->p_entries[counter]; p_entry != NULL;
+        p_entry = p_next) {
+      p_next = p_entry->p_next;
+      _clear(p_table, p_entry);
+    }
   }
 
-  // Store value void pointer for return from function
-  p_value_storage = p_current->p_value;
-
-  /*
-   * If there is no previous entry prior to target entry, redefine "head node"
-   * sitting at this hash slot. Otherwise, redefine the previous node's p_next
-   * data member. If the current node has no next property, implying it sits at
-   * the end of the linked list, apply NULL as the redefined value. Otherwise,
-   * set the next node as the redefined value.
-   */
-  *((!p_previous) ? &p_table->p_entries[hash] : &p_previous->p_next) =
-    (!p_current->p_next) ? NULL : p_current->p_next;
-
-  // Deallocate space reserved for this property
-  _clear(p_current);
+  p_table->p_snapshot = NULL;
+  p_table->allocator.p_free(p_snapshot->p_entries,
+    p_table->allocator.p_context);
+  p_table->allocator.p_free(p_snapshot, p_table->allocator.p_context);
+}
 
-  // Return cached value void pointer
-  return p_value_storage;
+/**
+ * @brief The <code>ch_stats</code> function fills in <code>p_stats</code> with
+ * the size, count, memory use, eviction count and slot array backing of
+ * <code>p_table</code>. It reads only counters maintained by the table and so
+ * runs in constant time.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_stats t_stats* Receives the statistics
+ * @return void
+ */
+void ch_stats(t_table * p_table, t_stats * p_stats) {
+  p_stats->size = p_table->size;
+  p_stats->count = p_table->count;
+  p_stats->bytes = p_table->bytes;
+  p_stats->budget = p_table->budget;
+  p_stats->evictions = p_table->evictions;
+  p_stats->pages = p_table->pages;
 }
 
 /**
@@ -282,7 +2272,8 @@ void * ch_delete(t_table * p_table, const char * p_key) {
  * is cleared of entries stored in heap memory. The function iterates through
  * the table and any linked lists and deallocates space reserved in heap for
  * each <code>t_property</code> and <code>p_key</code>. The private helper
- * function <code>_clear</code> is employed for this purpose.
+ * function <code>_clear</code> is employed for this purpose. Neither the
+ * eviction nor the expiry function is called.
  *
  * @param p_table t_table* A pointer to the specific hash table
  * @return void
@@ -290,20 +2281,39 @@ void * ch_delete(t_table * p_table, const char * p_key) {
 void ch_clear(t_table * p_table) {
 
   // Declarations
-  t_property * p_entry;
-  int counter;
+  t_property * p_entry, * p_next;
+  unsigned long int counter, remaining;
+  int shared;
 
   // Define counter int
   counter = 0;
+  remaining = p_table->count;
+
+  // Iterate through table entries, deallocating every property of each list,
+  // and stop once all are gone rather than touching every page of the array.
+  // A list shared with a snapshot is left to it.
+  while (remaining != 0 && counter < p_table->size) {
+    shared = _shared(p_table, counter);
+    p_entry = p_table->p_entries[counter];
+    p_table->p_entries[counter++] = NULL;
 
-  // Iterate through table entries, deallocating all space associated with each
-  while (counter < p_table->size) {
-    p_entry = p_table->p_entries[counter++];
+    while (p_entry != NULL) {
+      p_next = p_entry->p_next;
 
-    if (p_entry != NULL) {
-      _clear(p_entry);
+      if (!shared) {
+        _clear(p_table, p_entry);
+      }
+
+      p_entry = p_next;
+      remaining--;
     }
   }
+
+  p_table->count = 0;
+  p_table->cursor = 0;
+  p_table->bytes = sizeof(t_table) + sizeof(t_property *) * p_table->size;
+  p_table->p_newest = NULL;
+  p_table->p_oldest = NULL;
 }
 
 /**
@@ -312,38 +2322,81 @@ void ch_clear(t_table * p_table) {
  * representing the desired number of table hash slots and the associated size
  * of the table's <code>p_entries</code> data member, an array of
  * <code>t_property<code> <code>struct<code>s. The function allocates space in
- * heap memory for the table and the array.
+ * heap memory for the table and the array. It is equivalent to calling
+ * <code>ch_create_ex</code> without options.
  *
  * @param table_size unsigned longint Desired number of table slots
  * @return t_table* A pointer to the specific hash table
  */
 t_table * ch_create(unsigned long int table_size) {
+  return ch_create_ex(table_size, NULL);
+}
+
+/**
+ * @brief The <code>ch_create_ex</code> function constructs a new hash table of
+ * <code>table_size</code> slots as <code>ch_create</code> does, applying the
+ * settings in <code>p_options</code>. If <code>p_options</code> is
+ * <code>NULL</code>, every setting takes its default.
+ *
+ * @param table_size unsigned long int Desired number of table slots
+ * @param p_options const t_options* Table settings, or <code>NULL</code>
+ * @return t_table* A pointer to the specific hash table
+ */
+t_table * ch_create_ex(unsigned long int table_size,
+    const t_options * p_options) {
 
   // Declarations
   t_table * p_table;
-  int counter;
+  t_allocator allocator;
 
-  // Definitions
-  p_table = NULL;
-  counter = 0;
+  // Definition
+  allocator = (p_options != NULL && p_options->p_allocator != NULL)
+    ? *p_options->p_allocator : ALLOCATOR;
 
   // Allocate space for table and its array of key/value properties
-  p_table = malloc(sizeof(t_table));
-  p_table->p_entries = malloc(sizeof(t_property *) * table_size);
+  if ((p_table = allocator.p_malloc(sizeof(t_table), allocator.p_context)) ==
+      NULL) {
+    return NULL;
+  }
 
-  // Set size of table for properties/hash slots
-  p_table->size = table_size;
+  p_table->allocator = allocator;
 
-  // Ensure space was successfully allocated for both
-  if (p_table == NULL || p_table->p_entries == NULL) {
-    ch_destroy(p_table);
+  if ((p_table->p_entries = _slots(p_table, table_size, (p_options != NULL) ?
+      p_options->huge_pages : 0)) == NULL) {
+    allocator.p_free(p_table, allocator.p_context);
     return NULL;
   }
 
-  // Set default value of NULL for all hash slots
-  while (counter < table_size) {
-    p_table->p_entries[counter++] = NULL;
-  }
+  // Set size of table for properties/hash slots
+  p_table->size = table_size;
+  p_table->count = 0;
+  p_table->flags = 0;
+  p_table->p_expire = NULL;
+  p_table->cursor = 0;
+  p_table->bytes = sizeof(t_table) + sizeof(t_property *) * table_size;
+  p_table->evictions = 0;
+  p_table->p_newest = NULL;
+  p_table->p_oldest = NULL;
+
+  // Apply cache and budget settings, if given
+  p_table->capacity = (p_options != NULL) ? p_options->capacity : 0;
+  p_table->p_evict = (p_options != NULL) ? p_options->p_evict : NULL;
+  p_table->budget = (p_options != NULL) ? p_options->budget : 0;
+  p_table->policy = (p_options != NULL) ? p_options->policy : CH_BUDGET_EVICT;
+  p_table->p_size = (p_options != NULL) ? p_options->p_size : NULL;
+
+  // No memory reserved yet, and no snapshot taken
+  p_table->p_snapshot = NULL;
+  p_table->p_spare = NULL;
+  p_table->spares = 0;
+  p_table->p_reserves = NULL;
+  p_table->p_key_cursor = NULL;
+  p_table->p_key_limit = NULL;
+
+  // Apply elastic settings, if given
+  p_table->low_watermark = (p_options != NULL) ? p_options->low_watermark : 0;
+  p_table->minimum = (p_options != NULL && p_options->min_size != 0)
+    ? p_options->min_size : 1;
 
   return p_table;
 }
@@ -361,20 +2414,28 @@ t_table * ch_create(unsigned long int table_size) {
  */
 void ch_destroy(t_table * p_table) {
 
-  // Run through table entries array if populated
-  if ((sizeof(p_table->p_entries) / sizeof(t_property)) > 0) {
-    ch_clear(p_table);
-  }
+  // Declarations
+  t_allocator allocator;
+  t_reserve * p_reserve;
 
-  // Free table entries if extant
-  if (p_table->p_entries != NULL) {
-    free(p_table->p_entries);
-    p_table->p_entries = NULL;
+  // Nothing to deallocate for a table never created
+  if (p_table == NULL) {
+    return;
   }
 
-  // Free table if extant
-  if (p_table != NULL) {
-    free(p_table);
-    p_table = NULL;
+  // Run through table entries, deallocating every property
+  ch_clear(p_table);
+
+  // Free reserved blocks, table entries, then table itself, through its own
+  // allocator
+  allocator = p_table->allocator;
+  _spill(p_table);
+
+  while ((p_reserve = p_table->p_reserves) != NULL) {
+    p_table->p_reserves = p_reserve->p_next;
+    allocator.p_free(p_reserve, allocator.p_context);
   }
-}
\ No newline at end of file
+
+  _unslot(p_table, p_table->p_entries, p_table->mapped);
+  allocator.p_free(p_table, allocator.p_context);
+}
@@ -9,32 +9,291 @@
 #define __CHASH_H_
 
 /**
- * @brief The <code>s_property</code> <code>struct</code> contains three data
+ * @brief The <code>s_property</code> <code>struct</code> contains nine data
  * members for each hash table property. These are <code>p_key</code>, a string
  * that serves as the key for the key/value pair constituting the property;
  * <code>p_value</code>, a void pointer to the address of the associated value;
- * and <code>p_next</code>, a pointer to the next node in the linked list that
- * forms if a hash slot has more than one key/value pair associated with itself.
+ * <code>p_next</code>, a pointer to the next node in the linked list that
+ * forms if a hash slot has more than one key/value pair associated with itself;
+ * <code>hash</code>, the unreduced hash of <code>p_key</code>, cached so that
+ * list walks may skip most string comparisons; <code>expires</code>, the
+ * time on the monotonic clock, in milliseconds, after which the property is
+ * treated as absent, or 0 if it never expires; <code>bytes</code>, the memory
+ * charged to the table for the property, its key and its value;
+ * <code>p_newer</code> and <code>p_older</code>, which in a table with a
+ * capacity or budget link every property into a list ordered by recency of
+ * use; and <code>reserved</code>, whose bits record whether the property and
+ * its key were carved from a block allocated by <code>ch_reserve</code>, and
+ * so must not be freed on their own.
  */
 typedef struct s_property {
   char * p_key;                 /**< String representing the key of the pair */
   void * p_value;               /**< Void pointer representing the value */
   struct s_property * p_next;   /**< Next node if linked list exists at slot */
+  unsigned long int hash;       /**< Cached hash of the key string */
+  unsigned long int expires;    /**< Expiry time in milliseconds, or 0 */
+  unsigned long int bytes;      /**< Bytes charged for this property */
+  struct s_property * p_newer;  /**< Next more recently used property */
+  struct s_property * p_older;  /**< Next less recently used property */
+  unsigned int reserved;        /**< Which of property and key were reserved */
 } t_property;
 
 /**
- * @brief The <code>t_table</code> <code>struct</code> has a pair of data
- * members, namely <code>size</code>, which denotes the desired number of hash
- * slots in the table, and <code>p_entries</code>, a double pointer/array of
- * <code>t_property</code>s constituting the properties of the hash table. The
- * author has seen macros used in place of the <code>size</code> member, but
- * elected to use a run-time value rather than a compile-time value.
+ * @brief The <code>t_key</code> <code>struct</code> is a pre-hashed key handle
+ * built by <code>ch_key</code>. It pairs a key string with its length and its
+ * unreduced hash so that keys looked up repeatedly, such as metric names or
+ * route identifiers, need not be rehashed on every call. The handle borrows
+ * <code>p_key</code> and does not own it.
+ */
+typedef struct {
+  const char * p_key;           /**< Borrowed string representing the key */
+  unsigned long int length;     /**< Length of the key string */
+  unsigned long int hash;       /**< Unreduced hash of the key string */
+} t_key;
+
+/**
+ * @brief The <code>CH_MOVE_TO_FRONT</code> flag may be set in a table's
+ * <code>flags</code> data member to make the table self-organizing. With the
+ * flag set, every successful lookup moves the property found to the head of
+ * its slot's list, which greatly shortens list walks under skewed (e.g.
+ * Zipfian) access patterns at the cost of a few pointer writes per lookup.
+ */
+#define CH_MOVE_TO_FRONT 0x1
+
+/**
+ * @brief The <code>t_allocator</code> <code>struct</code> is a table of memory
+ * functions through which a table obtains and releases all of its memory: the
+ * table itself, its slot array, its properties and their key copies. Each
+ * function is passed <code>p_context</code>, which may point at whatever state
+ * the allocator requires, such as an arena or a memory pool. The functions
+ * follow the contracts of <code>malloc</code>, <code>realloc</code> and
+ * <code>free</code>, save that <code>p_free</code> need not accept
+ * <code>NULL</code>, as it is never passed it.
+ */
+typedef struct {
+  void * (* p_malloc)(unsigned long int size, void * p_context); /**< Alloc */
+  void * (* p_realloc)(void * p_block, unsigned long int size,
+    void * p_context);          /**< Resizes an allocated block */
+  void (* p_free)(void * p_block, void * p_context); /**< Releases a block */
+  void * p_context;             /**< State passed to each function */
+} t_allocator;
+
+/**
+ * @brief The <code>CH_BUDGET_EVICT</code> policy makes a table with a memory
+ * budget evict least recently used properties until a write fits the budget.
+ * A write too large to fit even an otherwise empty table is refused without
+ * evicting anything.
+ */
+#define CH_BUDGET_EVICT 0
+
+/**
+ * @brief The <code>CH_BUDGET_FAIL</code> policy makes a table with a memory
+ * budget reject any write that would exceed it, leaving the table unchanged.
+ */
+#define CH_BUDGET_FAIL 1
+
+/**
+ * @brief The <code>CH_PAGES_NORMAL</code> value of <code>t_stats</code>'s
+ * <code>pages</code> member reports a slot array backed by ordinary pages.
+ */
+#define CH_PAGES_NORMAL 0
+
+/**
+ * @brief The <code>CH_PAGES_TRANSPARENT</code> value reports a slot array for
+ * which transparent huge pages were requested from a system that has them
+ * enabled. Whether each region is in fact backed by one is decided by the
+ * kernel as it is touched, and depends on free memory at that time.
+ */
+#define CH_PAGES_TRANSPARENT 1
+
+/**
+ * @brief The <code>CH_PAGES_EXPLICIT</code> value reports a slot array mapped
+ * from the system's reserved pool of huge pages.
+ */
+#define CH_PAGES_EXPLICIT 2
+
+/**
+ * @brief The <code>CH_MERGE_REPLACE</code> policy makes
+ * <code>ch_merge</code> overwrite a key present in both tables with the source
+ * table's value.
+ */
+#define CH_MERGE_REPLACE 0
+
+/**
+ * @brief The <code>CH_MERGE_KEEP</code> policy makes <code>ch_merge</code>
+ * leave a key present in both tables with the destination table's value.
+ */
+#define CH_MERGE_KEEP 1
+
+/**
+ * @brief The <code>CH_SET_UNION</code> operation of <code>ch_set</code>
+ * yields every key present in either table.
+ */
+#define CH_SET_UNION 0
+
+/**
+ * @brief The <code>CH_SET_INTERSECTION</code> operation of <code>ch_set</code>
+ * yields every key present in both tables.
+ */
+#define CH_SET_INTERSECTION 1
+
+/**
+ * @brief The <code>CH_SET_DIFFERENCE</code> operation of <code>ch_set</code>
+ * yields every key of the left table absent from the right.
+ */
+#define CH_SET_DIFFERENCE 2
+
+/**
+ * @brief The <code>t_options</code> <code>struct</code> gathers the settings
+ * that must be fixed when a table is created, and is passed to
+ * <code>ch_create_ex</code>. A <code>capacity</code> other than 0 turns the
+ * table into a cache holding at most that many properties: once it is full,
+ * each new key evicts the least recently used property, whose key and value
+ * are first passed to <code>p_evict</code>, if set, so that the caller may
+ * release the value. An expired property among the few least recently used is
+ * instead dropped through <code>p_expire</code>, as it would be on lookup.
+ * <br />
+ * <br />
+ * A <code>budget</code> other than 0 likewise bounds the bytes the table may
+ * occupy, counting the table itself, its slot array, and each property along
+ * with its key copy. If <code>p_size</code> is set, it is called with each
+ * non-<code>NULL</code> value stored by <code>ch_put</code> and the number of
+ * bytes it returns is charged as well. A write that would exceed the budget
+ * is handled according to <code>policy</code>, either
+ * <code>CH_BUDGET_EVICT</code> or <code>CH_BUDGET_FAIL</code>.
+ * <br />
+ * <br />
+ * If <code>p_allocator</code> is set, the table allocates all of its memory
+ * through the functions it holds, which are copied into the table; otherwise
+ * the standard library's are used.
+ * <br />
+ * <br />
+ * If <code>huge_pages</code> is nonzero, the slot array is mapped directly
+ * from the kernel on huge pages, so that lookups in a table of hundreds of
+ * millions of slots do not miss the TLB on nearly every probe. Reserved huge
+ * pages are tried first, then transparent huge pages, then ordinary pages;
+ * <code>ch_stats</code> reports which were obtained or, for transparent huge
+ * pages, requested. The properties remain with the allocator, which may
+ * itself draw on huge pages.
+ * <br />
+ * <br />
+ * A <code>low_watermark</code> other than 0 makes the table elastic: an insert
+ * raising the count above the number of slots doubles them, and a deletion
+ * leaving fewer properties than <code>low_watermark</code> percent of the
+ * slots halves them, though never below <code>min_size</code> slots, or one if
+ * it is 0. A watermark under 50 keeps the two from alternating.
+ */
+typedef struct {
+  unsigned long int capacity;   /**< Maximum number of properties, or 0 */
+  void (* p_evict)(const char * p_key, void * p_value); /**< Eviction hook */
+  unsigned long int budget;     /**< Maximum number of bytes, or 0 */
+  unsigned int policy;          /**< Response to exceeding the budget */
+  unsigned long int (* p_size)(const void * p_value); /**< Value size */
+  const t_allocator * p_allocator; /**< Memory functions, or NULL */
+  unsigned int huge_pages;      /**< Nonzero to map slots on huge pages */
+  unsigned int low_watermark;   /**< Load percentage to shrink below, or 0 */
+  unsigned long int min_size;   /**< Fewest slots to shrink to, or 0 */
+} t_options;
+
+/**
+ * @brief The <code>t_stats</code> <code>struct</code> is filled in by
+ * <code>ch_stats</code> with a snapshot of a table's occupancy.
+ */
+typedef struct {
+  unsigned long int size;       /**< Number of hash slots */
+  unsigned long int count;      /**< Number of properties stored */
+  unsigned long int bytes;      /**< Bytes currently charged to the table */
+  unsigned long int budget;     /**< Maximum number of bytes, or 0 */
+  unsigned long int evictions;  /**< Properties evicted since creation */
+  unsigned int pages;           /**< Backing of the slot array, CH_PAGES_* */
+} t_stats;
+
+/**
+ * @brief The <code>t_snapshot</code> <code>struct</code> is an immutable view
+ * of a <code>t_table</code> as it stood when <code>ch_snapshot</code> was
+ * called. It holds its own copy of the table's slot array, whose lists it
+ * shares with the table until the table first writes to each slot.
+ */
+typedef struct {
+  unsigned long int size;       /**< Number of hash slots when taken */
+  unsigned long int count;      /**< Number of properties when taken */
+  t_property ** p_entries;      /**< Slot array as it stood when taken */
+} t_snapshot;
+
+/**
+ * @brief The <code>t_table</code> <code>struct</code> has as its principal
+ * data members <code>size</code>, which denotes the desired number of hash
+ * slots in the table, <code>p_entries</code>, a double pointer/array of
+ * <code>t_property</code>s constituting the properties of the hash table, and
+ * <code>count</code>, the number of properties stored. Besides these,
+ * <code>flags</code> is a bit set of optional behaviors such as
+ * <code>CH_MOVE_TO_FRONT</code>; <code>p_expire</code> is a function called
+ * with the key and value of each property dropped on expiry so that the caller
+ * may release the value; and <code>cursor</code> is the slot at which the next
+ * call to <code>ch_expire_step</code> resumes. The flags and callback are
+ * cleared by <code>ch_create</code> and may be set by the caller at any time
+ * thereafter. The remaining members hold the cache, budget and allocator
+ * settings given to <code>ch_create_ex</code>, the bytes charged and
+ * properties evicted so far, the two ends of the recency list, the length and
+ * backing of the slot array if it was mapped on huge pages, the watermark and
+ * floor of an elastic table, the memory set aside by <code>ch_reserve</code>,
+ * and the live snapshot, if any. The author has seen macros used in place of
+ * the <code>size</code> member, but elected to use a run-time value rather
+ * than a compile-time value.
  */
 typedef struct {
   unsigned long int size;       /**< Total number of hash slots/properties */
   t_property ** p_entries;      /**< Array of properties existing in table */
+  unsigned long int count;      /**< Number of properties stored */
+  unsigned int flags;           /**< Bit set of optional table behaviors */
+  void (* p_expire)(const char * p_key, void * p_value); /**< Expiry hook */
+  unsigned long int cursor;     /**< Next slot swept by ch_expire_step */
+  unsigned long int capacity;   /**< Maximum number of properties, or 0 */
+  void (* p_evict)(const char * p_key, void * p_value); /**< Eviction hook */
+  unsigned long int budget;     /**< Maximum number of bytes, or 0 */
+  unsigned int policy;          /**< Response to exceeding the budget */
+  unsigned long int (* p_size)(const void * p_value); /**< Value size */
+  unsigned long int bytes;      /**< Bytes currently charged to the table */
+  unsigned long int evictions;  /**< Properties evicted since creation */
+  t_allocator allocator;        /**< Memory functions used by the table */
+  t_property * p_newest;        /**< Most recently used property */
+  t_property * p_oldest;        /**< Least recently used property */
+  unsigned long int mapped;     /**< Length of a mapped slot array, or 0 */
+  unsigned int pages;           /**< Backing of the slot array, CH_PAGES_* */
+  unsigned int low_watermark;   /**< Load percentage to shrink below, or 0 */
+  unsigned long int minimum;    /**< Fewest slots to shrink to */
+  t_property * p_spare;         /**< Reserved properties not yet in use */
+  unsigned long int spares;     /**< Number of spare properties */
+  void * p_reserves;            /**< Blocks allocated by ch_reserve */
+  char * p_key_cursor;          /**< Next unused byte of reserved key space */
+  char * p_key_limit;           /**< End of reserved key space */
+  t_snapshot * p_snapshot;      /**< Live snapshot sharing lists, or NULL */
 } t_table;
 
+/**
+ * @brief The <code>ch_hash</code> function exposes the module's private string
+ * hashing function, <code>_hash</code>, to companion modules and callers that
+ * must agree with a <code>t_table</code> on the slot a given key occupies. The
+ * returned value has not yet been reduced modulo the number of table slots.
+ *
+ * @param p_key const char* The string to be hashed
+ * @return unsigned long int The resultant unreduced hash value
+ */
+unsigned long int ch_hash(const char * p_key);
+
+/**
+ * @brief The <code>ch_key</code> function builds a <code>t_key</code> handle
+ * for the string <code>p_key</code>, measuring and hashing it once. The handle
+ * refers to, rather than copies, the string, which must therefore outlive it.
+ * Handles may be passed to <code>ch_put_h</code>, <code>ch_get_h</code> and
+ * <code>ch_delete_h</code> any number of times and with any table, since the
+ * stored hash has not been reduced to a particular table's size.
+ *
+ * @param p_key const char* The string for which to build a handle
+ * @return t_key The handle, holding the string, its length and its hash
+ */
+t_key ch_key(const char * p_key);
+
 /**
  * @brief The <code>ch_put</code> function maps the specified prop key denoted
  * by the formal parameter <code>p_key</code> to the void pointer passed to the
@@ -43,7 +302,12 @@ typedef struct {
  * update the value at that key, and <code>p_value</code> is mapped to the key.
  * If two key/value pairs are mapped to the same hash slot, the function creates
  * a linked list at that hash slot rather than lose the new pair or rehash and
- * resize the entire structure.
+ * resize the entire structure. In a table with a capacity, a new key arriving
+ * when the table is full evicts the least recently used property. In a table
+ * with a budget, a write exceeding it either evicts or fails, as the table's
+ * policy dictates, and a write larger than the whole budget always fails; a
+ * failed write returns <code>NULL</code> and evicts nothing for the sake of
+ * the capacity.
  * <br />
  * <br />
  * The author acknowledges that a rehash could be done here if multiple pairs
@@ -61,6 +325,66 @@ typedef struct {
  */
 void * ch_put(t_table * p_table, const char * p_key, void * p_value);
 
+/**
+ * @brief The <code>ch_put_h</code> function behaves exactly as
+ * <code>ch_put</code>, save that the key is supplied as a <code>t_key</code>
+ * handle built beforehand by <code>ch_key</code>. The key string is thus not
+ * rehashed, and only the slot's list is walked.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_handle const t_key* The pre-hashed key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return p_value void* A void pointer representing the value of the pair
+ */
+void * ch_put_h(t_table * p_table, const t_key * p_handle, void * p_value);
+
+/**
+ * @brief The <code>ch_put_ttl</code> function behaves exactly as
+ * <code>ch_put</code>, save that the property expires <code>ttl</code>
+ * milliseconds from now on the monotonic clock. Once expired, the property is
+ * treated as absent by every function but <code>ch_delete</code>, and is
+ * dropped, with the table's <code>p_expire</code> function called on its key
+ * and value, by the first <code>ch_get</code> or <code>ch_expire_step</code>
+ * to come across it, or by a table with a capacity or budget making room. A
+ * <code>ttl</code> of 0 makes the property permanent, as does a later call to
+ * <code>ch_put</code> for the same key.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @param ttl unsigned long int Lifetime of the property in milliseconds
+ * @return p_value void* A void pointer representing the value of the pair
+ */
+void * ch_put_ttl(t_table * p_table, const char * p_key, void * p_value,
+  unsigned long int ttl);
+
+/**
+ * @brief The <code>ch_upsert</code> function combines <code>ch_get</code> and
+ * <code>ch_put</code> into a single walk of the slot's list. If a property is
+ * found at <code>p_key</code>, the address of its <code>p_value</code> data
+ * member is returned; otherwise a new property whose value is
+ * <code>NULL</code> is appended to the list and the address of its value is
+ * returned instead. The caller may read or write through the returned pointer
+ * to update the value in place, and the integer at <code>p_inserted</code>, if
+ * provided, is set to denote which of the two cases occurred. The pointer
+ * remains valid until the property is deleted, evicted or dropped on expiry,
+ * or the table is cleared or compacted with <code>ch_compact</code>, which
+ * moves every property. Taking a snapshot with <code>ch_snapshot</code>
+ * likewise invalidates every pointer obtained beforehand, as the first write
+ * to a slot the snapshot shares moves the slot's properties into copies; a
+ * write through an old pointer would then alter the snapshot and be lost to
+ * the table. Call <code>ch_upsert</code> again after taking a snapshot, as
+ * it returns the address within the table's own copy. Values written through
+ * the pointer are not charged against a table's budget until next stored with
+ * <code>ch_put</code>.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_inserted int* Set to 1 if the property was created, else 0
+ * @return void** Address of the property's value, or <code>NULL</code>
+ */
+void ** ch_upsert(t_table * p_table, const char * p_key, int * p_inserted);
+
 /**
  * @brief The <code>ch_get</code> function is used to retrieve the void pointer
  * constituting the value of the <code>t_property</code> type that is associated
@@ -75,6 +399,25 @@ void * ch_put(t_table * p_table, const char * p_key, void * p_value);
  */
 void * ch_get(t_table * p_table, const char * p_key);
 
+/**
+ * @brief The <code>ch_get_h</code> function behaves exactly as
+ * <code>ch_get</code>, save that the key is supplied as a <code>t_key</code>
+ * handle built beforehand by <code>ch_key</code>. As each property caches the
+ * hash of its key, properties in the slot's list whose hashes differ from the
+ * handle's are passed over without their key strings being compared. If the
+ * table's <code>flags</code> include <code>CH_MOVE_TO_FRONT</code>, a property
+ * found further down the list is moved to its head, so that frequently read
+ * keys settle at the front of their slots and are found after a single
+ * comparison. An expired property is dropped rather than returned, as
+ * described for <code>ch_put_ttl</code>. In a table with a capacity, the
+ * property found becomes the most recently used.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_handle const t_key* The pre-hashed key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_get_h(t_table * p_table, const t_key * p_handle);
+
 /**
  * @brief The <code>ch_delete</code> function is used to remove the property
  * specified via the parameter constituting the key, namely <code>p_key</code>.
@@ -90,13 +433,216 @@ void * ch_get(t_table * p_table, const char * p_key);
  */
 void * ch_delete(t_table * p_table, const char * p_key);
 
+/**
+ * @brief The <code>ch_delete_h</code> function behaves exactly as
+ * <code>ch_delete</code>, save that the key is supplied as a
+ * <code>t_key</code> handle built beforehand by <code>ch_key</code>.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_handle const t_key* The pre-hashed key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_delete_h(t_table * p_table, const t_key * p_handle);
+
+/**
+ * @brief The <code>ch_expire_step</code> function performs a bounded amount of
+ * expiry work, so that expired properties which are never looked up again are
+ * still reclaimed without the table being swept in one long pass. Each call
+ * walks the lists of at most <code>budget</code> slots, resuming at the slot
+ * where the previous call stopped and wrapping around at the end of the table,
+ * and drops every expired property found as <code>ch_get</code> would.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param budget unsigned long int Maximum number of slots to examine
+ * @return unsigned long int Number of properties dropped
+ */
+unsigned long int ch_expire_step(t_table * p_table, unsigned long int budget);
+
+/**
+ * @brief The <code>ch_reserve</code> function prepares <code>p_table</code>
+ * for <code>count</code> more properties ahead of a bulk load. The slot array
+ * is first grown, if need be, to at least one slot per property expected, and
+ * a single block is then allocated holding enough properties, along with key
+ * storage for identifiers of typical length, to make up any shortfall in the
+ * table's spares. Until it is used up, new keys take no allocation and cause
+ * no rehashing. Reserved memory is not charged against a budget until used,
+ * and is released only when the table is destroyed.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param count unsigned long int Number of properties about to be added
+ * @return int 0 on success, -1 if memory could not be allocated
+ */
+int ch_reserve(t_table * p_table, unsigned long int count);
+
+/**
+ * @brief The <code>ch_compact</code> function rebuilds <code>p_table</code>
+ * after heavy churn. The slot array is replaced by one sized to the number of
+ * properties, though no smaller than the table's minimum, and every property
+ * and key is copied, slot by slot, into a single block allocated for the
+ * purpose, so that each list is laid out contiguously rather than scattered
+ * over the blocks freed since the table was filled. The properties copied are
+ * then freed, as is any memory set aside by <code>ch_reserve</code>, whether
+ * used or not, so pointers returned by <code>ch_upsert</code> no longer hold.
+ * Should any allocation fail, or a snapshot of the table be live, the table is
+ * left as it was.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @return int 0 on success, -1 if the table could not be compacted
+ */
+int ch_compact(t_table * p_table);
+
+/**
+ * @brief The <code>ch_clone</code> function constructs a deep copy of
+ * <code>p_table</code>, with the same size, settings, flags and hooks. The
+ * properties and keys of the copy are laid out in a single block, allocated
+ * once and filled slot by slot, and each copy keeps its original's cached
+ * hash and expiry, so no key is rehashed. In a table with a capacity or
+ * budget, the copy's properties are ordered by recency as the originals are.
+ * The values themselves are shared.
+ *
+ * @param p_table t_table* A pointer to the hash table to be copied
+ * @return t_table* A pointer to the copy, or <code>NULL</code>
+ */
+t_table * ch_clone(t_table * p_table);
+
+/**
+ * @brief The <code>ch_merge</code> function writes every property of
+ * <code>p_source</code> into <code>p_table</code>. Where a key is present in
+ * both, <code>policy</code> decides the outcome: <code>CH_MERGE_REPLACE</code>
+ * takes the source's value and expiry, <code>CH_MERGE_KEEP</code> leaves the
+ * destination's. The source keys absent from the destination are counted
+ * first, and the destination is presized once with properties and key storage
+ * for at least those keys, drawing on any left from earlier reservations, so
+ * that repeatedly merging overlapping tables reserves memory only for keys
+ * actually added. A new block is reserved only if the key storage left is too
+ * small, and is then given room for keys of typical length; otherwise any
+ * shortfall of spares is made up by single allocations.
+ * Each key is placed by its cached hash rather than being rehashed. Expired
+ * source properties are skipped.
+ *
+ * @param p_table t_table* A pointer to the destination hash table
+ * @param p_source t_table* A pointer to the source hash table, left unchanged
+ * @param policy unsigned int <code>CH_MERGE_REPLACE</code> or
+ * <code>CH_MERGE_KEEP</code>
+ * @return int 0 on success, -1 if the policy is unknown or a write failed, in
+ * which case the keys merged before it remain
+ */
+int ch_merge(t_table * p_table, t_table * p_source, unsigned int policy);
+
+/**
+ * @brief The <code>ch_set</code> function constructs a table holding the
+ * result of <code>operation</code> on the keys of <code>p_left</code> and
+ * <code>p_right</code>: <code>CH_SET_UNION</code>,
+ * <code>CH_SET_INTERSECTION</code> or <code>CH_SET_DIFFERENCE</code>, the
+ * last being the keys of <code>p_left</code> absent from
+ * <code>p_right</code>. Keys are tested and placed by their cached hashes, so
+ * none is rehashed, and each takes its value and expiry from
+ * <code>p_left</code> if present there. The new table uses
+ * <code>p_left</code>'s allocator and has a slot for every key the result
+ * could hold. Expired properties count as absent.
+ *
+ * @param p_left t_table* A pointer to the left operand
+ * @param p_right t_table* A pointer to the right operand
+ * @param operation unsigned int One of the <code>CH_SET_*</code> operations
+ * @return t_table* A pointer to the resultant table, or <code>NULL</code>
+ */
+t_table * ch_set(t_table * p_left, t_table * p_right, unsigned int operation);
+
+/**
+ * @brief The <code>ch_set_each</code> function streams the result of
+ * <code>operation</code>, as computed by <code>ch_set</code>, to
+ * <code>p_visit</code> rather than building a table, calling it with each key,
+ * its value and <code>p_context</code>. Only partition <code>part</code> of
+ * <code>parts</code> is computed: each operand's slots are split into
+ * <code>parts</code> ranges of near equal length, and every key of the result
+ * falls in exactly one partition. As the tables are only read, each partition
+ * may be computed by its own thread, provided that neither table is written
+ * meanwhile.
+ *
+ * @param p_left t_table* A pointer to the left operand
+ * @param p_right t_table* A pointer to the right operand
+ * @param operation unsigned int One of the <code>CH_SET_*</code> operations
+ * @param part unsigned long int The partition to compute, below
+ * <code>parts</code>
+ * @param parts unsigned long int Number of partitions, 1 for the whole result
+ * @param p_visit void (*)(const char*, void*, void*) Receives each key/value
+ * pair
+ * @param p_context void* State passed to <code>p_visit</code>
+ * @return int 0 on success, -1 if the operation or partition is invalid
+ */
+int ch_set_each(t_table * p_left, t_table * p_right, unsigned int operation,
+  unsigned long int part, unsigned long int parts,
+  void (* p_visit)(const char * p_key, void * p_value, void * p_context),
+  void * p_context);
+
+/**
+ * @brief The <code>ch_snapshot</code> function takes an immutable view of
+ * <code>p_table</code> as it stands. Only the slot array is copied; every list
+ * is shared with the table until the table next writes to its slot, when the
+ * table copies the list for itself and leaves the original to the snapshot.
+ * The table's writer may thus carry on while other threads read the snapshot
+ * through <code>ch_snapshot_get</code>, as nothing the snapshot can reach is
+ * ever modified. While a snapshot is live, the table does not resize, and a
+ * read neither moves nor drops a property in a shared list. Because a write
+ * moves a shared list's properties into copies, every pointer returned by
+ * <code>ch_upsert</code> before the snapshot was taken must be discarded:
+ * writing through one would modify the snapshot rather than the table.
+ * <br />
+ * <br />
+ * One snapshot may be live per table. Tables with a capacity, a budget or the
+ * <code>CH_MOVE_TO_FRONT</code> flag, whose lookups reorder properties, cannot
+ * be snapshotted.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @return t_snapshot* The snapshot, or <code>NULL</code> if none can be taken
+ */
+t_snapshot * ch_snapshot(t_table * p_table);
+
+/**
+ * @brief The <code>ch_snapshot_get</code> function retrieves the value that
+ * was mapped to <code>p_key</code> when <code>p_snapshot</code> was taken. A
+ * property that has since expired is reported absent. The snapshot is never
+ * modified, so any number of threads may call this function at once.
+ *
+ * @param p_snapshot const t_snapshot* A pointer to the snapshot
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_snapshot_get(const t_snapshot * p_snapshot, const char * p_key);
+
+/**
+ * @brief The <code>ch_snapshot_release</code> function releases
+ * <code>p_snapshot</code>, which must have been taken of
+ * <code>p_table</code>, freeing every list the table has since replaced and
+ * allowing the table to resize again. A snapshot must be released before its
+ * table is destroyed, and only once no thread is reading it.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_snapshot t_snapshot* A pointer to the snapshot
+ * @return void
+ */
+void ch_snapshot_release(t_table * p_table, t_snapshot * p_snapshot);
+
+/**
+ * @brief The <code>ch_stats</code> function fills in <code>p_stats</code> with
+ * the size, count, memory use, eviction count and slot array backing of
+ * <code>p_table</code>. It reads only counters maintained by the table and so
+ * runs in constant time.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_stats t_stats* Receives the statistics
+ * @return void
+ */
+void ch_stats(t_table * p_table, t_stats * p_stats);
+
 /**
  * @brief The <code>ch_clear</code> function is used as the means by which the
  * given hash table specified via the formal parameter <code>p_table</code>
  * is cleared of entries stored in heap memory. The function iterates through
  * the table and any linked lists and deallocates space reserved in heap for
  * each <code>t_property</code> and <code>p_key</code>. The private helper
- * function <code>_clear</code> is employed for this purpose.
+ * function <code>_clear</code> is employed for this purpose. Neither the
+ * eviction nor the expiry function is called.
  *
  * @param p_table t_table* A pointer to the specific hash table
  * @return void
@@ -109,13 +655,27 @@ void ch_clear(t_table * p_table);
  * representing the desired number of table hash slots and the associated size
  * of the table's <code>p_entries</code> data member, an array of
  * <code>t_property<code> <code>struct<code>s. The function allocates space in
- * heap memory for the table and the array.
+ * heap memory for the table and the array. It is equivalent to calling
+ * <code>ch_create_ex</code> without options.
  *
  * @param table_size unsigned longint Desired number of table slots
  * @return t_table* A pointer to the specific hash table
  */
 t_table * ch_create(unsigned long int table_size);
 
+/**
+ * @brief The <code>ch_create_ex</code> function constructs a new hash table of
+ * <code>table_size</code> slots as <code>ch_create</code> does, applying the
+ * settings in <code>p_options</code>. If <code>p_options</code> is
+ * <code>NULL</code>, every setting takes its default.
+ *
+ * @param table_size unsigned long int Desired number of table slots
+ * @param p_options const t_options* Table settings, or <code>NULL</code>
+ * @return t_table* A pointer to the specific hash table
+ */
+t_table * ch_create_ex(unsigned long int table_size,
+  const t_options * p_options);
+
 /**
  * @brief The <code>ch_destroy</code> function is used simply to deallocate all
  * space reserved for the hash table specified via the formal parameter
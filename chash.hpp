@@ -0,0 +1,543 @@
+/**
+ * @file chash.hpp
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Header-only C++17 interface to CHash with typed keys and values
+ */
+
+#ifndef __CHASH_HPP_
+#define __CHASH_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace chash {
+
+/**
+ * @brief The <code>hash</code> functor is the default hash of
+ * <code>chash::map</code>. For most key types it defers to
+ * <code>std::hash</code>; the string specialization below replaces it.
+ */
+template <class K>
+struct hash : std::hash<K> {};
+
+/**
+ * @brief The <code>std::string</code> specialization of <code>hash</code>
+ * computes the same djb2 variant as the C table's <code>_hash</code>, so that
+ * a key occupies the same slot in either interface. It is transparent, meaning
+ * lookups may pass a <code>std::string_view</code> or string literal without
+ * a temporary <code>std::string</code> being constructed.
+ */
+template <>
+struct hash<std::string> {
+  using is_transparent = void;
+
+  std::size_t operator()(std::string_view key) const noexcept {
+    unsigned long int value = 0;
+
+    for (char character : key) {
+      value = value * 33 + character;
+    }
+
+    return value;
+  }
+};
+
+/**
+ * @brief The <code>map</code> class template is a typed counterpart of
+ * <code>t_table</code>. It keeps the C table's layout, an array of slots each
+ * heading a singly linked list of nodes, but each node stores its
+ * <code>std::pair&lt;const K, V&gt;</code> inline, so values are moved or
+ * constructed in place rather than referenced through a void pointer. Every
+ * node also caches its key's hash, so growing the table never calls the hash
+ * function again and list walks skip most key comparisons.
+ * <br />
+ * <br />
+ * When both <code>Hash</code> and <code>Eq</code> declare
+ * <code>is_transparent</code>, as the defaults do for string keys, the lookup
+ * members accept any key-like type. <code>try_emplace</code> hashes its key
+ * once and constructs the value only if the key is absent.
+ */
+template <
+  class K,
+  class V,
+  class Hash = chash::hash<K>,
+  class Eq = std::equal_to<>,
+  class Alloc = std::allocator<std::pair<const K, V>>
+>
+class map {
+
+  struct node {
+    std::pair<const K, V> value;
+    std::size_t hash;
+    node * p_next;
+
+    template <class... Args>
+    node(std::size_t hash, Args &&... args)
+      : value(std::forward<Args>(args)...), hash(hash), p_next(nullptr) {}
+  };
+
+  using node_alloc =
+    typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+  using node_traits = std::allocator_traits<node_alloc>;
+  using slot_alloc =
+    typename std::allocator_traits<Alloc>::template rebind_alloc<node *>;
+  using slot_traits = std::allocator_traits<slot_alloc>;
+
+  template <class Q, class = void>
+  struct is_transparent : std::false_type {};
+
+  template <class Q>
+  struct is_transparent<Q, std::void_t<typename Q::is_transparent>>
+    : std::true_type {};
+
+  template <class L>
+  using lookup_key = std::conditional_t<
+    is_transparent<Hash>::value && is_transparent<Eq>::value, L, K>;
+
+public:
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = std::pair<const K, V>;
+  using size_type = std::size_t;
+  using hasher = Hash;
+  using key_equal = Eq;
+  using allocator_type = Alloc;
+
+  /**
+   * @brief Forward iterator visiting slots in order and each slot's list from
+   * head to tail, as <code>_print_hash_table</code> does in the C driver.
+   */
+  template <bool Const>
+  class basic_iterator {
+    friend class map;
+
+    using slot_pointer = std::conditional_t<Const, node * const *, node **>;
+
+    slot_pointer p_slot;
+    slot_pointer p_end;
+    node * p_node;
+
+    basic_iterator(slot_pointer p_slot, slot_pointer p_end, node * p_node)
+      : p_slot(p_slot), p_end(p_end), p_node(p_node) {
+      settle();
+    }
+
+    void settle() {
+      while (p_node == nullptr && p_slot != p_end && ++p_slot != p_end) {
+        p_node = *p_slot;
+      }
+    }
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<Const, const value_type &,
+      value_type &>;
+    using pointer = std::conditional_t<Const, const value_type *,
+      value_type *>;
+
+    basic_iterator() : p_slot(nullptr), p_end(nullptr), p_node(nullptr) {}
+
+    template <bool C = Const, class = std::enable_if_t<C>>
+    basic_iterator(const basic_iterator<false> & other)
+      : p_slot(other.p_slot), p_end(other.p_end), p_node(other.p_node) {}
+
+    reference operator*() const { return p_node->value; }
+    pointer operator->() const { return &p_node->value; }
+
+    basic_iterator & operator++() {
+      p_node = p_node->p_next;
+      settle();
+      return *this;
+    }
+
+    basic_iterator operator++(int) {
+      basic_iterator previous = *this;
+      ++*this;
+      return previous;
+    }
+
+    friend bool operator==(const basic_iterator & a, const basic_iterator & b) {
+      return a.p_node == b.p_node;
+    }
+
+    friend bool operator!=(const basic_iterator & a, const basic_iterator & b) {
+      return a.p_node != b.p_node;
+    }
+  };
+
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  explicit map(size_type slots = 16, const Hash & hash = Hash(),
+      const Eq & equal = Eq(), const Alloc & alloc = Alloc())
+    : hash_(hash), equal_(equal), nodes_(alloc), slots_alloc_(alloc),
+      p_entries_(nullptr), size_(0), count_(0) {
+    allocate(slots > 0 ? slots : 1);
+  }
+
+  map(const map & other)
+    : hash_(other.hash_), equal_(other.equal_),
+      nodes_(node_traits::select_on_container_copy_construction(
+        other.nodes_)),
+      slots_alloc_(slot_traits::select_on_container_copy_construction(
+        other.slots_alloc_)),
+      p_entries_(nullptr), size_(0), count_(0) {
+    allocate(other.size_ > 0 ? other.size_ : 1);
+
+    // The destructor does not run for a partial copy, so release it here
+    try {
+      for (const value_type & value : other) {
+        emplace_hashed(hash_(value.first), value);
+      }
+    } catch (...) {
+      clear();
+      release();
+      throw;
+    }
+  }
+
+  /**
+   * @brief Takes over the slots and nodes of <code>other</code>, which is left
+   * empty with no slots at all. Every member tolerates that state, and the
+   * first insertion gives the map a slot again.
+   */
+  map(map && other) noexcept
+    : hash_(std::move(other.hash_)), equal_(std::move(other.equal_)),
+      nodes_(std::move(other.nodes_)),
+      slots_alloc_(std::move(other.slots_alloc_)),
+      p_entries_(std::exchange(other.p_entries_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      count_(std::exchange(other.count_, 0)) {}
+
+  map & operator=(map other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  ~map() {
+    clear();
+    release();
+  }
+
+  void swap(map & other) noexcept {
+    using std::swap;
+    swap(hash_, other.hash_);
+    swap(equal_, other.equal_);
+    swap(nodes_, other.nodes_);
+    swap(slots_alloc_, other.slots_alloc_);
+    swap(p_entries_, other.p_entries_);
+    swap(size_, other.size_);
+    swap(count_, other.count_);
+  }
+
+  iterator begin() noexcept {
+    return iterator(p_entries_, p_entries_ + size_,
+      size_ > 0 ? p_entries_[0] : nullptr);
+  }
+
+  iterator end() noexcept {
+    return iterator(p_entries_ + size_, p_entries_ + size_, nullptr);
+  }
+
+  const_iterator begin() const noexcept {
+    return const_iterator(p_entries_, p_entries_ + size_,
+      size_ > 0 ? p_entries_[0] : nullptr);
+  }
+
+  const_iterator end() const noexcept {
+    return const_iterator(p_entries_ + size_, p_entries_ + size_, nullptr);
+  }
+
+  size_type size() const noexcept { return count_; }
+  bool empty() const noexcept { return count_ == 0; }
+  size_type bucket_count() const noexcept { return size_; }
+
+  /**
+   * @brief Inserts a value constructed from <code>args</code> under
+   * <code>key</code> if, and only if, the key is absent. The key is hashed
+   * exactly once, and neither the key nor the value is copied or moved when
+   * an existing entry is found.
+   */
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(const K & key, Args &&... args) {
+    return try_emplace_impl(key, std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(K && key, Args &&... args) {
+    return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Heterogeneous overload of <code>try_emplace</code>. The key is
+   * converted to <code>K</code> only when a node must actually be created.
+   */
+  template <class L, class... Args, class = std::enable_if_t<
+    !std::is_same_v<std::decay_t<L>, K> &&
+    is_transparent<Hash>::value && is_transparent<Eq>::value>>
+  std::pair<iterator, bool> try_emplace(L && key, Args &&... args) {
+    return try_emplace_impl(std::forward<L>(key), std::forward<Args>(args)...);
+  }
+
+  std::pair<iterator, bool> insert(const value_type & value) {
+    return try_emplace(value.first, value.second);
+  }
+
+  std::pair<iterator, bool> insert(value_type && value) {
+    return try_emplace(value.first, std::move(value.second));
+  }
+
+  /**
+   * @brief Maps <code>key</code> to <code>value</code>, replacing any extant
+   * value, mirroring the update-on-match behavior of <code>ch_put</code>.
+   */
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(const K & key, M && value) {
+    std::pair<iterator, bool> result =
+      try_emplace(key, std::forward<M>(value));
+
+    if (!result.second) {
+      result.first->second = std::forward<M>(value);
+    }
+
+    return result;
+  }
+
+  template <class L = K>
+  V & operator[](L && key) {
+    return try_emplace(std::forward<L>(key)).first->second;
+  }
+
+  template <class L>
+  iterator find(const L & key) {
+    return locate(static_cast<const lookup_key<L> &>(key));
+  }
+
+  template <class L>
+  const_iterator find(const L & key) const {
+    return const_cast<map *>(this)->find(key);
+  }
+
+  template <class L>
+  bool contains(const L & key) const {
+    return find(key) != end();
+  }
+
+  template <class L>
+  size_type count(const L & key) const {
+    return contains(key) ? 1 : 0;
+  }
+
+  template <class L>
+  V & at(const L & key) {
+    iterator found = find(key);
+
+    if (found == end()) {
+      throw std::out_of_range("chash::map::at");
+    }
+
+    return found->second;
+  }
+
+  template <class L>
+  const V & at(const L & key) const {
+    return const_cast<map *>(this)->at(key);
+  }
+
+  /**
+   * @brief Removes the entry stored under <code>key</code>, if any, using
+   * the same predecessor walk as <code>ch_delete</code>.
+   */
+  template <class L>
+  size_type erase(const L & key) {
+    const lookup_key<L> & lookup = key;
+
+    if (size_ == 0) {
+      return 0;
+    }
+
+    std::size_t hash = hash_(lookup);
+    node ** p_link = &p_entries_[hash % size_];
+
+    for (; *p_link != nullptr; p_link = &(*p_link)->p_next) {
+      if ((*p_link)->hash == hash && equal_((*p_link)->value.first, lookup)) {
+        node * p_node = *p_link;
+        *p_link = p_node->p_next;
+        destroy(p_node);
+        count_--;
+        return 1;
+      }
+    }
+
+    return 0;
+  }
+
+  void clear() noexcept {
+    for (size_type counter = 0; counter < size_; counter++) {
+      node * p_node = p_entries_[counter];
+
+      while (p_node != nullptr) {
+        node * p_next = p_node->p_next;
+        destroy(p_node);
+        p_node = p_next;
+      }
+
+      p_entries_[counter] = nullptr;
+    }
+
+    count_ = 0;
+  }
+
+  /**
+   * @brief Redistributes all nodes into <code>slots</code> slots using their
+   * cached hashes. No key is rehashed and no node is reallocated.
+   */
+  void rehash(size_type slots) {
+    node ** p_previous = p_entries_;
+    size_type previous = size_;
+
+    if (slots < count_) {
+      slots = count_;
+    }
+
+    allocate(slots > 0 ? slots : 1);
+
+    for (size_type counter = 0; counter < previous; counter++) {
+      node * p_node = p_previous[counter];
+
+      while (p_node != nullptr) {
+        node * p_next = p_node->p_next;
+        link(p_node);
+        p_node = p_next;
+      }
+    }
+
+    if (p_previous != nullptr) {
+      slot_traits::deallocate(slots_alloc_, p_previous, previous);
+    }
+  }
+
+  void reserve(size_type count) {
+    if (count > size_) {
+      rehash(count);
+    }
+  }
+
+private:
+  template <class L>
+  iterator locate(const L & key) {
+    if (size_ == 0) {
+      return end();
+    }
+
+    std::size_t hash = hash_(key);
+    node ** p_slot = &p_entries_[hash % size_];
+
+    for (node * p_node = *p_slot; p_node != nullptr; p_node = p_node->p_next) {
+      if (p_node->hash == hash && equal_(p_node->value.first, key)) {
+        return iterator(p_slot, p_entries_ + size_, p_node);
+      }
+    }
+
+    return end();
+  }
+
+  template <class L, class... Args>
+  std::pair<iterator, bool> try_emplace_impl(L && key, Args &&... args) {
+    std::size_t hash = hash_(key);
+
+    // A moved-from map has no slots until it is next written
+    if (size_ == 0) {
+      allocate(1);
+    }
+
+    node ** p_link = &p_entries_[hash % size_];
+
+    for (; *p_link != nullptr; p_link = &(*p_link)->p_next) {
+      if ((*p_link)->hash == hash && equal_((*p_link)->value.first, key)) {
+        return {iterator(&p_entries_[hash % size_], p_entries_ + size_,
+          *p_link), false};
+      }
+    }
+
+    return {emplace_hashed(hash, std::piecewise_construct,
+      std::forward_as_tuple(std::forward<L>(key)),
+      std::forward_as_tuple(std::forward<Args>(args)...)), true};
+  }
+
+  template <class... Args>
+  iterator emplace_hashed(std::size_t hash, Args &&... args) {
+
+    // Grow first, so that a throwing allocation leaves the map unchanged
+    if (count_ + 1 > size_) {
+      rehash(size_ > 0 ? size_ * 2 : 1);
+    }
+
+    node * p_node = node_traits::allocate(nodes_, 1);
+
+    try {
+      node_traits::construct(nodes_, p_node, hash,
+        std::forward<Args>(args)...);
+    } catch (...) {
+      node_traits::deallocate(nodes_, p_node, 1);
+      throw;
+    }
+
+    link(p_node);
+    count_++;
+    return iterator(&p_entries_[hash % size_], p_entries_ + size_, p_node);
+  }
+
+  void link(node * p_node) {
+    node ** p_link = &p_entries_[p_node->hash % size_];
+
+    while (*p_link != nullptr) {
+      p_link = &(*p_link)->p_next;
+    }
+
+    p_node->p_next = nullptr;
+    *p_link = p_node;
+  }
+
+  void destroy(node * p_node) noexcept {
+    node_traits::destroy(nodes_, p_node);
+    node_traits::deallocate(nodes_, p_node, 1);
+  }
+
+  void allocate(size_type slots) {
+    p_entries_ = slot_traits::allocate(slots_alloc_, slots);
+    std::fill(p_entries_, p_entries_ + slots, nullptr);
+    size_ = slots;
+  }
+
+  void release() noexcept {
+    if (p_entries_ != nullptr) {
+      slot_traits::deallocate(slots_alloc_, p_entries_, size_);
+      p_entries_ = nullptr;
+    }
+  }
+
+  Hash hash_;
+  Eq equal_;
+  node_alloc nodes_;
+  slot_alloc slots_alloc_;
+  node ** p_entries_;
+  size_type size_;
+  size_type count_;
+};
+
+} // namespace chash
+
+#endif
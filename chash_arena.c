@@ -0,0 +1,213 @@
+/**
+ * @file chash_arena.c
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Source file for a bump-pointer arena usable as a CHash allocator
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chash_arena.h"
+
+/**
+ * @brief Alignment of every allocation, sufficient for any object type
+ */
+#define CH_ARENA_ALIGN (_Alignof(max_align_t))
+
+/**
+ * @brief Space reserved ahead of each allocation to record its size, which
+ * <code>_realloc</code> needs in order to copy the old contents
+ */
+#define CH_ARENA_HEADER CH_ARENA_ALIGN
+
+/**
+ * @brief The <code>_round</code> helper function rounds <code>size</code> up
+ * to a multiple of <code>CH_ARENA_ALIGN</code>.
+ *
+ * @param size unsigned long int The unrounded byte count
+ * @return unsigned long int The rounded byte count
+ */
+static unsigned long int _round(unsigned long int size) {
+  return (size + CH_ARENA_ALIGN - 1) & ~((unsigned long int) CH_ARENA_ALIGN -
+    1);
+}
+
+/**
+ * @brief The <code>_refill</code> helper function obtains a new block able to
+ * hold at least <code>size</code> bytes and makes it the current block.
+ *
+ * @param p_arena t_arena* A pointer to the arena
+ * @param size unsigned long int Bytes the new block must hold
+ * @return int 1 on success, 0 if allocation failed
+ */
+static int _refill(t_arena * p_arena, unsigned long int size) {
+
+  // Declaration
+  t_arena_block * p_block;
+
+  if (size < p_arena->block_size) {
+    size = p_arena->block_size;
+  }
+
+  if ((p_block = malloc(_round(sizeof(t_arena_block)) + size)) == NULL) {
+    return 0;
+  }
+
+  p_block->p_next = p_arena->p_blocks;
+  p_block->size = size;
+  p_arena->p_blocks = p_block;
+  p_arena->p_cursor = (unsigned char *) p_block + _round(sizeof(t_arena_block));
+  p_arena->p_limit = p_arena->p_cursor + size;
+
+  return 1;
+}
+
+/**
+ * @brief The <code>_malloc</code> helper function carves <code>size</code>
+ * bytes, preceded by a header recording that size, from the arena passed as
+ * <code>p_context</code>.
+ *
+ * @param size unsigned long int Number of bytes to allocate
+ * @param p_context void* The arena
+ * @return void* The allocation, or <code>NULL</code>
+ */
+static void * _malloc(unsigned long int size, void * p_context) {
+
+  // Declarations
+  t_arena * p_arena;
+  unsigned char * p_block;
+  unsigned long int total;
+
+  // Definitions
+  p_arena = p_context;
+  total = CH_ARENA_HEADER + _round(size);
+
+  if ((unsigned long int) (p_arena->p_limit - p_arena->p_cursor) < total &&
+      !_refill(p_arena, total)) {
+    return NULL;
+  }
+
+  p_block = p_arena->p_cursor;
+  p_arena->p_cursor += total;
+  *(unsigned long int *) p_block = size;
+
+  return p_block + CH_ARENA_HEADER;
+}
+
+/**
+ * @brief The <code>_realloc</code> helper function allocates
+ * <code>size</code> bytes afresh from the arena and copies into them as much
+ * of <code>p_block</code> as fits. The old allocation is abandoned.
+ *
+ * @param p_block void* The allocation to be resized, or <code>NULL</code>
+ * @param size unsigned long int New size of the allocation in bytes
+ * @param p_context void* The arena
+ * @return void* The new allocation, or <code>NULL</code>
+ */
+static void * _realloc(void * p_block, unsigned long int size,
+    void * p_context) {
+
+  // Declarations
+  void * p_resized;
+  unsigned long int previous;
+
+  if ((p_resized = _malloc(size, p_context)) == NULL || p_block == NULL) {
+    return p_resized;
+  }
+
+  previous = *(unsigned long int *) ((unsigned char *) p_block -
+    CH_ARENA_HEADER);
+  memcpy(p_resized, p_block, (previous < size) ? previous : size);
+
+  return p_resized;
+}
+
+/**
+ * @brief The <code>_free</code> helper function does nothing, as arena memory
+ * is reclaimed only when the arena is destroyed.
+ *
+ * @param p_block void* Unused
+ * @param p_context void* Unused
+ * @return void
+ */
+static void _free(void * p_block, void * p_context) {
+  (void) p_block;
+  (void) p_context;
+}
+
+/**
+ * @brief The <code>ch_arena_create</code> function constructs an empty arena
+ * that obtains memory in blocks of <code>block_size</code> bytes. Requests too
+ * large for a block are given a block of their own.
+ *
+ * @param block_size unsigned long int Usable bytes in each block
+ * @return t_arena* A pointer to the arena, or <code>NULL</code>
+ */
+t_arena * ch_arena_create(unsigned long int block_size) {
+
+  // Declaration
+  t_arena * p_arena;
+
+  if ((p_arena = malloc(sizeof(t_arena))) == NULL) {
+    return NULL;
+  }
+
+  p_arena->block_size = block_size;
+  p_arena->p_blocks = NULL;
+  p_arena->p_cursor = NULL;
+  p_arena->p_limit = NULL;
+
+  return p_arena;
+}
+
+/**
+ * @brief The <code>ch_arena_allocator</code> function returns a
+ * <code>t_allocator</code> drawing on <code>p_arena</code>, to be passed to
+ * <code>ch_create_ex</code>. Its <code>p_free</code> does nothing and its
+ * <code>p_realloc</code> always copies into a fresh allocation, so memory is
+ * only reclaimed when the arena itself is destroyed. A table using the arena
+ * need not be passed to <code>ch_destroy</code> before the arena is destroyed,
+ * since walking its properties would free nothing.
+ *
+ * @param p_arena t_arena* A pointer to the arena
+ * @return t_allocator The allocator
+ */
+t_allocator ch_arena_allocator(t_arena * p_arena) {
+
+  // Declaration
+  t_allocator allocator;
+
+  // Definitions
+  allocator.p_malloc = _malloc;
+  allocator.p_realloc = _realloc;
+  allocator.p_free = _free;
+  allocator.p_context = p_arena;
+
+  return allocator;
+}
+
+/**
+ * @brief The <code>ch_arena_destroy</code> function releases every block of
+ * <code>p_arena</code>, and with them every allocation made from it, before
+ * deallocating the arena itself.
+ *
+ * @param p_arena t_arena* A pointer to the arena
+ * @return void
+ */
+void ch_arena_destroy(t_arena * p_arena) {
+
+  // Declaration
+  t_arena_block * p_block;
+
+  if (p_arena == NULL) {
+    return;
+  }
+
+  while ((p_block = p_arena->p_blocks) != NULL) {
+    p_arena->p_blocks = p_block->p_next;
+    free(p_block);
+  }
+
+  free(p_arena);
+}
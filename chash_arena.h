@@ -0,0 +1,72 @@
+/**
+ * @file chash_arena.h
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Header file for a bump-pointer arena usable as a CHash allocator
+ */
+
+#ifndef __CHASH_ARENA_H_
+#define __CHASH_ARENA_H_
+
+#include "chash.h"
+
+/**
+ * @brief The <code>s_arena_block</code> <code>struct</code> heads each block
+ * of memory obtained by an arena. Blocks are chained newest first so that the
+ * whole arena can be released in one walk.
+ */
+typedef struct s_arena_block {
+  struct s_arena_block * p_next; /**< Block obtained before this one */
+  unsigned long int size;       /**< Usable bytes following this header */
+} t_arena_block;
+
+/**
+ * @brief The <code>t_arena</code> <code>struct</code> is a bump-pointer
+ * allocator. Each allocation is carved from the current block by advancing
+ * <code>p_cursor</code>; when the block is exhausted, a new one of
+ * <code>block_size</code> bytes is obtained from <code>malloc</code>.
+ * Individual allocations are never returned, so an arena suits tables that are
+ * built and then destroyed as a whole, such as per-request or per-load tables.
+ */
+typedef struct {
+  unsigned long int block_size; /**< Usable bytes in each ordinary block */
+  t_arena_block * p_blocks;     /**< Most recently obtained block */
+  unsigned char * p_cursor;     /**< Next free byte of the current block */
+  unsigned char * p_limit;      /**< End of the current block */
+} t_arena;
+
+/**
+ * @brief The <code>ch_arena_create</code> function constructs an empty arena
+ * that obtains memory in blocks of <code>block_size</code> bytes. Requests too
+ * large for a block are given a block of their own.
+ *
+ * @param block_size unsigned long int Usable bytes in each block
+ * @return t_arena* A pointer to the arena, or <code>NULL</code>
+ */
+t_arena * ch_arena_create(unsigned long int block_size);
+
+/**
+ * @brief The <code>ch_arena_allocator</code> function returns a
+ * <code>t_allocator</code> drawing on <code>p_arena</code>, to be passed to
+ * <code>ch_create_ex</code>. Its <code>p_free</code> does nothing and its
+ * <code>p_realloc</code> always copies into a fresh allocation, so memory is
+ * only reclaimed when the arena itself is destroyed. A table using the arena
+ * need not be passed to <code>ch_destroy</code> before the arena is destroyed,
+ * since walking its properties would free nothing.
+ *
+ * @param p_arena t_arena* A pointer to the arena
+ * @return t_allocator The allocator
+ */
+t_allocator ch_arena_allocator(t_arena * p_arena);
+
+/**
+ * @brief The <code>ch_arena_destroy</code> function releases every block of
+ * <code>p_arena</code>, and with them every allocation made from it, before
+ * deallocating the arena itself.
+ *
+ * @param p_arena t_arena* A pointer to the arena
+ * @return void
+ */
+void ch_arena_destroy(t_arena * p_arena);
+
+#endif
@@ -0,0 +1,359 @@
+/**
+ * @file chash_cuckoo.c
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Source file for CHash tables using bucketized cuckoo hashing
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "chash_cuckoo.h"
+
+/**
+ * @brief Number of evictions attempted by a single insertion before the table
+ * is judged to contain a cycle and is doubled
+ */
+#define CH_CUCKOO_KICKS 500
+
+/**
+ * @brief The <code>_hash</code> helper function computes both of a key's
+ * hashes in a single pass over the string. The first is the djb2 variant used
+ * by <code>t_table</code>; the second is FNV-1a. The two must be independent,
+ * since keys agreeing on both hashes compete for the same pair of buckets, and
+ * more than <code>2 * CH_CUCKOO_WIDTH</code> such keys could never be placed.
+ *
+ * @param p_key const char* The string to be hashed
+ * @param p_hashes unsigned long int* Receives the two hashes
+ * @return void
+ */
+static void _hash(const char * p_key, unsigned long int * p_hashes) {
+
+  // Definitions
+  p_hashes[0] = 0L;
+  p_hashes[1] = 0xCBF29CE484222325UL;
+
+  while (*p_key != '\0') {
+    p_hashes[0] = p_hashes[0] * 33 + *p_key;
+    p_hashes[1] = (p_hashes[1] ^ (unsigned char) *p_key++) * 0x100000001B3UL;
+  }
+}
+
+/**
+ * @brief The <code>_bucket</code> helper function returns the first slot of
+ * the bucket selected by <code>hash</code> within the slot array
+ * <code>p_slots</code> of <code>size</code> buckets.
+ *
+ * @param p_slots t_cuckoo_slot* The table's slot array
+ * @param size unsigned long int Number of buckets in the array
+ * @param hash unsigned long int Either of a key's hashes
+ * @return t_cuckoo_slot* The first slot of the bucket
+ */
+static t_cuckoo_slot * _bucket(t_cuckoo_slot * p_slots, unsigned long int size,
+    unsigned long int hash) {
+  return &p_slots[(hash % size) * CH_CUCKOO_WIDTH];
+}
+
+/**
+ * @brief The <code>_find</code> helper function searches the two buckets of a
+ * key for the slot holding it.
+ *
+ * @param p_table t_cuckoo* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key
+ * @param p_hashes unsigned long int* The key's two hashes
+ * @return t_cuckoo_slot* The slot holding the key, or <code>NULL</code>
+ */
+static t_cuckoo_slot * _find(t_cuckoo * p_table, const char * p_key,
+    unsigned long int * p_hashes) {
+
+  // Declarations
+  t_cuckoo_slot * p_slot;
+  int choice, position;
+
+  for (choice = 0; choice < 2; choice++) {
+    p_slot = _bucket(p_table->p_slots, p_table->size, p_hashes[choice]);
+
+    for (position = 0; position < CH_CUCKOO_WIDTH; position++, p_slot++) {
+      if (p_slot->p_key != NULL && p_slot->hashes[choice] == p_hashes[choice] &&
+          strcmp(p_slot->p_key, p_key) == 0) {
+        return p_slot;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief The <code>_place</code> helper function stores the pair held in
+ * <code>p_carry</code> in the slot array <code>p_slots</code>. If both of the
+ * pair's buckets are full, a slot of one of them is chosen at random, its
+ * occupant is swapped into <code>p_carry</code>, and the displaced pair is
+ * placed in turn. Should <code>CH_CUCKOO_KICKS</code> evictions pass without a
+ * free slot being found, the function gives up and replays the evictions in
+ * reverse, restoring both the slot array and <code>p_carry</code> to the state
+ * in which they were passed.
+ *
+ * @param p_table t_cuckoo* The table, whose generator state is advanced
+ * @param p_slots t_cuckoo_slot* The slot array receiving the pair
+ * @param size unsigned long int Number of buckets in the array
+ * @param p_carry t_cuckoo_slot* The pair to be placed
+ * @return int 1 if the pair was placed, otherwise 0
+ */
+static int _place(t_cuckoo * p_table, t_cuckoo_slot * p_slots,
+    unsigned long int size, t_cuckoo_slot * p_carry) {
+
+  // Declarations
+  t_cuckoo_slot * p_slot, * p_path[CH_CUCKOO_KICKS], swap;
+  int kicks, choice, position;
+
+  for (kicks = 0; kicks < CH_CUCKOO_KICKS; kicks++) {
+
+    // Take the first free slot in either bucket
+    for (choice = 0; choice < 2; choice++) {
+      p_slot = _bucket(p_slots, size, p_carry->hashes[choice]);
+
+      for (position = 0; position < CH_CUCKOO_WIDTH; position++, p_slot++) {
+        if (p_slot->p_key == NULL) {
+          *p_slot = *p_carry;
+          return 1;
+        }
+      }
+    }
+
+    // Advance the xorshift generator and evict a random occupant
+    p_table->state ^= p_table->state << 13;
+    p_table->state ^= p_table->state >> 7;
+    p_table->state ^= p_table->state << 17;
+
+    p_slot = _bucket(p_slots, size, p_carry->hashes[p_table->state & 1]) +
+      (p_table->state >> 1) % CH_CUCKOO_WIDTH;
+    swap = *p_slot;
+    *p_slot = *p_carry;
+    *p_carry = swap;
+    p_path[kicks] = p_slot;
+  }
+
+  // Undo the evictions, newest first
+  while (kicks-- > 0) {
+    swap = *p_path[kicks];
+    *p_path[kicks] = *p_carry;
+    *p_carry = swap;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief The <code>_grow</code> helper function doubles the number of buckets
+ * and moves every pair into the new slot array using its cached hashes. The
+ * old array is left untouched until every pair has been placed, so that if the
+ * new array itself proves unplaceable, it can be discarded and the doubling
+ * attempted again without loss.
+ *
+ * @param p_table t_cuckoo* A pointer to the specific hash table
+ * @return int 1 on success, 0 if allocation failed
+ */
+static int _grow(t_cuckoo * p_table) {
+
+  // Declarations
+  t_cuckoo_slot * p_slots, carry;
+  unsigned long int size, counter;
+
+  for (size = p_table->size * 2; ; size *= 2) {
+    if ((p_slots = calloc(size * CH_CUCKOO_WIDTH, sizeof(t_cuckoo_slot))) ==
+        NULL) {
+      return 0;
+    }
+
+    for (counter = 0; counter < p_table->size * CH_CUCKOO_WIDTH; counter++) {
+      if (p_table->p_slots[counter].p_key == NULL) {
+        continue;
+      }
+
+      carry = p_table->p_slots[counter];
+
+      if (!_place(p_table, p_slots, size, &carry)) {
+        break;
+      }
+    }
+
+    if (counter == p_table->size * CH_CUCKOO_WIDTH) {
+      break;
+    }
+
+    free(p_slots);
+  }
+
+  free(p_table->p_slots);
+  p_table->p_slots = p_slots;
+  p_table->size = size;
+
+  return 1;
+}
+
+/**
+ * @brief The <code>ch_cuckoo_create</code> function constructs an empty cuckoo
+ * table of <code>table_size</code> buckets, each able to hold
+ * <code>CH_CUCKOO_WIDTH</code> pairs. Unlike <code>t_table</code>, the table
+ * grows as needed, so the size given is only a starting point.
+ *
+ * @param table_size unsigned long int Initial number of buckets
+ * @return t_cuckoo* A pointer to the specific hash table
+ */
+t_cuckoo * ch_cuckoo_create(unsigned long int table_size) {
+
+  // Declaration
+  t_cuckoo * p_table;
+
+  if ((p_table = malloc(sizeof(t_cuckoo))) == NULL) {
+    return NULL;
+  }
+
+  p_table->size = (table_size > 0) ? table_size : 1;
+  p_table->count = 0;
+  p_table->state = 0x9E3779B97F4A7C15UL;
+  p_table->p_slots = calloc(p_table->size * CH_CUCKOO_WIDTH,
+    sizeof(t_cuckoo_slot));
+
+  if (p_table->p_slots == NULL) {
+    free(p_table);
+    return NULL;
+  }
+
+  return p_table;
+}
+
+/**
+ * @brief The <code>ch_cuckoo_put</code> function maps <code>p_key</code> to
+ * <code>p_value</code>, updating the value if the key is already present, as
+ * <code>ch_put</code> does. If neither of the key's buckets has a free slot,
+ * a pair is evicted from one to its alternate bucket, repeatedly, until a free
+ * slot is reached. Should that take too many evictions, the table is doubled
+ * and the insertion completed in the larger table.
+ *
+ * @param p_table t_cuckoo* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return void* The value, or <code>NULL</code> if allocation failed
+ */
+void * ch_cuckoo_put(t_cuckoo * p_table, const char * p_key, void * p_value) {
+
+  // Declarations
+  t_cuckoo_slot * p_slot, carry;
+
+  // Update value of extant pair
+  _hash(p_key, carry.hashes);
+
+  if ((p_slot = _find(p_table, p_key, carry.hashes)) != NULL) {
+    p_slot->p_value = p_value;
+    return p_value;
+  }
+
+  if ((carry.p_key = malloc(strlen(p_key) + 1)) == NULL) {
+    return NULL;
+  }
+
+  strcpy(carry.p_key, p_key);
+  carry.p_value = p_value;
+
+  // A failed placement leaves the table as it was, so grow and retry
+  while (!_place(p_table, p_table->p_slots, p_table->size, &carry)) {
+    if (!_grow(p_table)) {
+      free(carry.p_key);
+      return NULL;
+    }
+  }
+
+  p_table->count++;
+  return p_value;
+}
+
+/**
+ * @brief The <code>ch_cuckoo_get</code> function retrieves the value mapped to
+ * <code>p_key</code>, inspecting at most the <code>2 * CH_CUCKOO_WIDTH</code>
+ * slots of the key's two buckets.
+ *
+ * @param p_table t_cuckoo* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_cuckoo_get(t_cuckoo * p_table, const char * p_key) {
+
+  // Declarations
+  unsigned long int hashes[2];
+  t_cuckoo_slot * p_slot;
+
+  _hash(p_key, hashes);
+  p_slot = _find(p_table, p_key, hashes);
+
+  return (p_slot != NULL) ? p_slot->p_value : NULL;
+}
+
+/**
+ * @brief The <code>ch_cuckoo_delete</code> function removes the pair mapped to
+ * <code>p_key</code> and returns its value. The slot is simply emptied, as no
+ * other key's position depends on it.
+ *
+ * @param p_table t_cuckoo* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_cuckoo_delete(t_cuckoo * p_table, const char * p_key) {
+
+  // Declarations
+  unsigned long int hashes[2];
+  t_cuckoo_slot * p_slot;
+  void * p_value_storage;
+
+  _hash(p_key, hashes);
+
+  if ((p_slot = _find(p_table, p_key, hashes)) == NULL) {
+    return NULL;
+  }
+
+  p_value_storage = p_slot->p_value;
+  free(p_slot->p_key);
+  memset(p_slot, 0, sizeof(t_cuckoo_slot));
+  p_table->count--;
+
+  return p_value_storage;
+}
+
+/**
+ * @brief The <code>ch_cuckoo_clear</code> function deallocates every key in
+ * the table and empties every slot.
+ *
+ * @param p_table t_cuckoo* A pointer to the specific hash table
+ * @return void
+ */
+void ch_cuckoo_clear(t_cuckoo * p_table) {
+
+  // Declaration
+  unsigned long int counter;
+
+  for (counter = 0; counter < p_table->size * CH_CUCKOO_WIDTH; counter++) {
+    free(p_table->p_slots[counter].p_key);
+  }
+
+  memset(p_table->p_slots, 0,
+    sizeof(t_cuckoo_slot) * p_table->size * CH_CUCKOO_WIDTH);
+  p_table->count = 0;
+}
+
+/**
+ * @brief The <code>ch_cuckoo_destroy</code> function clears the table, then
+ * deallocates its slots and the table itself.
+ *
+ * @param p_table t_cuckoo* A pointer to the specific hash table
+ * @return void
+ */
+void ch_cuckoo_destroy(t_cuckoo * p_table) {
+
+  if (p_table == NULL) {
+    return;
+  }
+
+  ch_cuckoo_clear(p_table);
+  free(p_table->p_slots);
+  free(p_table);
+}
@@ -0,0 +1,110 @@
+/**
+ * @file chash_cuckoo.h
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Header file for CHash tables using bucketized cuckoo hashing
+ */
+
+#ifndef __CHASH_CUCKOO_H_
+#define __CHASH_CUCKOO_H_
+
+/**
+ * @brief Number of slots in each bucket of a <code>t_cuckoo</code>
+ */
+#define CH_CUCKOO_WIDTH 4
+
+/**
+ * @brief The <code>t_cuckoo_slot</code> <code>struct</code> holds a single
+ * key/value pair of a cuckoo table, along with both of the key's hashes so
+ * that moving the pair to its alternate bucket never requires the key to be
+ * rehashed. An empty slot has a <code>NULL</code> <code>p_key</code>.
+ */
+typedef struct {
+  char * p_key;                 /**< String representing the key of the pair */
+  void * p_value;               /**< Void pointer representing the value */
+  unsigned long int hashes[2];  /**< The key's first and second hashes */
+} t_cuckoo_slot;
+
+/**
+ * @brief The <code>t_cuckoo</code> <code>struct</code> is a hash table with
+ * <code>size</code> buckets of <code>CH_CUCKOO_WIDTH</code> slots each, stored
+ * contiguously in <code>p_slots</code>. Every key lives in one of exactly two
+ * buckets, chosen by two independent hash functions, so a lookup never reads
+ * more than two buckets regardless of how full the table is. There are no
+ * linked lists; an insert finding both buckets full evicts a resident pair to
+ * its alternate bucket, and so on, doubling the table if the evictions cycle.
+ */
+typedef struct {
+  unsigned long int size;       /**< Number of buckets */
+  unsigned long int count;      /**< Number of key/value pairs stored */
+  unsigned long int state;      /**< Generator state for choosing victims */
+  t_cuckoo_slot * p_slots;      /**< All buckets' slots, bucket by bucket */
+} t_cuckoo;
+
+/**
+ * @brief The <code>ch_cuckoo_create</code> function constructs an empty cuckoo
+ * table of <code>table_size</code> buckets, each able to hold
+ * <code>CH_CUCKOO_WIDTH</code> pairs. Unlike <code>t_table</code>, the table
+ * grows as needed, so the size given is only a starting point.
+ *
+ * @param table_size unsigned long int Initial number of buckets
+ * @return t_cuckoo* A pointer to the specific hash table
+ */
+t_cuckoo * ch_cuckoo_create(unsigned long int table_size);
+
+/**
+ * @brief The <code>ch_cuckoo_put</code> function maps <code>p_key</code> to
+ * <code>p_value</code>, updating the value if the key is already present, as
+ * <code>ch_put</code> does. If neither of the key's buckets has a free slot,
+ * a pair is evicted from one to its alternate bucket, repeatedly, until a free
+ * slot is reached. Should that take too many evictions, the table is doubled
+ * and the insertion completed in the larger table.
+ *
+ * @param p_table t_cuckoo* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return void* The value, or <code>NULL</code> if allocation failed
+ */
+void * ch_cuckoo_put(t_cuckoo * p_table, const char * p_key, void * p_value);
+
+/**
+ * @brief The <code>ch_cuckoo_get</code> function retrieves the value mapped to
+ * <code>p_key</code>, inspecting at most the <code>2 * CH_CUCKOO_WIDTH</code>
+ * slots of the key's two buckets.
+ *
+ * @param p_table t_cuckoo* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_cuckoo_get(t_cuckoo * p_table, const char * p_key);
+
+/**
+ * @brief The <code>ch_cuckoo_delete</code> function removes the pair mapped to
+ * <code>p_key</code> and returns its value. The slot is simply emptied, as no
+ * other key's position depends on it.
+ *
+ * @param p_table t_cuckoo* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_cuckoo_delete(t_cuckoo * p_table, const char * p_key);
+
+/**
+ * @brief The <code>ch_cuckoo_clear</code> function deallocates every key in
+ * the table and empties every slot.
+ *
+ * @param p_table t_cuckoo* A pointer to the specific hash table
+ * @return void
+ */
+void ch_cuckoo_clear(t_cuckoo * p_table);
+
+/**
+ * @brief The <code>ch_cuckoo_destroy</code> function clears the table, then
+ * deallocates its slots and the table itself.
+ *
+ * @param p_table t_cuckoo* A pointer to the specific hash table
+ * @return void
+ */
+void ch_cuckoo_destroy(t_cuckoo * p_table);
+
+#endif
@@ -0,0 +1,418 @@
+/**
+ * @file chash_freeze.c
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Source file for immutable, minimal perfect hash CHash tables
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "chash_freeze.h"
+
+/**
+ * @brief Average number of keys per pilot bucket. Larger values shrink the
+ * pilot array at the cost of longer pilot searches during construction.
+ */
+#define CH_FREEZE_LAMBDA 4
+
+/**
+ * @brief Percentage of the positions to which pilots map keys that are
+ * actually occupied. Leaving a few free keeps the last buckets placed, which
+ * hold a single key each, from searching through a table with almost no free
+ * slot left; with every position occupied, they would need as many tries as
+ * there are keys.
+ */
+#define CH_FREEZE_LOAD 99
+
+/**
+ * @brief Number of pilot values tried for a single bucket before construction
+ * is abandoned and restarted under a different seed.
+ */
+#define CH_FREEZE_TRIES (1UL << 20)
+
+/**
+ * @brief Number of seeds tried before <code>ch_freeze</code> gives up.
+ */
+#define CH_FREEZE_SEEDS 16
+
+/**
+ * @brief The <code>_mix</code> helper function is the finalizer of the
+ * SplitMix64 generator. It scrambles all 64 bits of <code>value</code> so that
+ * consecutive pilot values produce unrelated displacements.
+ *
+ * @param value uint64_t The value to be scrambled
+ * @return uint64_t The scrambled value
+ */
+static uint64_t _mix(uint64_t value) {
+  value ^= value >> 30;
+  value *= 0xBF58476D1CE4E5B9ULL;
+  value ^= value >> 27;
+  value *= 0x94D049BB133111EBULL;
+  return value ^ (value >> 31);
+}
+
+/**
+ * @brief The <code>_hash</code> helper function computes a seeded 64-bit FNV-1a
+ * hash of <code>p_key</code>. The table's own hash cannot be used here, as its
+ * multiplier of 33 maps short keys such as "Ab" and "BA" to identical values,
+ * and no choice of pilots can separate two keys with identical hashes.
+ *
+ * @param p_key const char* The string to be hashed
+ * @param seed uint64_t Seed mixed into the initial state
+ * @return uint64_t The resultant hash value
+ */
+static uint64_t _hash(const char * p_key, uint64_t seed) {
+
+  // Declaration
+  uint64_t value;
+
+  // Definition
+  value = 0xCBF29CE484222325ULL ^ _mix(seed);
+
+  while (*p_key != '\0') {
+    value = (value ^ (unsigned char) *p_key++) * 0x100000001B3ULL;
+  }
+
+  return _mix(value);
+}
+
+/**
+ * @brief The <code>_slot</code> helper function maps a key's hash and the pilot
+ * of its bucket to a position between 0 and <code>range</code>.
+ *
+ * @param hash uint64_t The key's hash
+ * @param pilot uint32_t The pilot assigned to the key's bucket
+ * @param range unsigned long int Number of positions
+ * @return unsigned long int The position
+ */
+static unsigned long int _slot(uint64_t hash, uint32_t pilot,
+    unsigned long int range) {
+  return (hash ^ _mix(pilot)) % range;
+}
+
+/**
+ * @brief The <code>_build</code> helper function attempts to assign a pilot to
+ * every bucket under the seed stored in <code>p_frozen</code>. Keys are first
+ * grouped by bucket with a counting sort, and buckets are then placed from the
+ * largest to the smallest, since the largest are the hardest to fit once the
+ * slot array begins to fill. Pilots place keys among <code>range</code>
+ * positions, slightly more than there are keys; once every bucket is placed,
+ * each key at a position past the last slot is moved into one of the slots
+ * left free, and its position remapped to that slot.
+ *
+ * @param p_frozen t_frozen* The frozen table under construction
+ * @param p_keys t_property** Every property of the source table
+ * @param p_hashes uint64_t* Scratch array of one hash per key
+ * @return int 1 if every bucket was placed, otherwise 0
+ */
+static int _build(t_frozen * p_frozen, t_property ** p_keys,
+    uint64_t * p_hashes) {
+
+  // Declarations
+  unsigned long int * p_starts, * p_order, * p_sorted, * p_positions;
+  unsigned long int counter, bucket, member, first, length, largest, slot;
+  unsigned char * p_taken;
+  uint32_t pilot;
+  int placed;
+
+  // Definitions
+  p_starts = calloc(p_frozen->bucket_count + 1, sizeof(unsigned long int));
+  p_order = malloc(sizeof(unsigned long int) * p_frozen->bucket_count);
+  p_sorted = malloc(sizeof(unsigned long int) * p_frozen->size);
+  p_taken = calloc(p_frozen->range, 1);
+  p_positions = NULL;
+  placed = 0;
+  largest = 0;
+
+  if (!p_starts || !p_order || !p_sorted || !p_taken) {
+    goto done;
+  }
+
+  // Count keys per bucket, then turn counts into starting offsets
+  for (counter = 0; counter < p_frozen->size; counter++) {
+    p_hashes[counter] = _hash(p_keys[counter]->p_key, p_frozen->seed);
+    p_starts[(p_hashes[counter] >> 32) % p_frozen->bucket_count + 1]++;
+  }
+
+  for (counter = 0; counter < p_frozen->bucket_count; counter++) {
+    if (p_starts[counter + 1] > largest) {
+      largest = p_starts[counter + 1];
+    }
+
+    p_starts[counter + 1] += p_starts[counter];
+  }
+
+  for (counter = 0; counter < p_frozen->size; counter++) {
+    bucket = (p_hashes[counter] >> 32) % p_frozen->bucket_count;
+    p_sorted[p_starts[bucket]++] = counter;
+  }
+
+  // Scattering advanced each offset to the next bucket's start; shift back
+  for (counter = p_frozen->bucket_count; counter > 0; counter--) {
+    p_starts[counter] = p_starts[counter - 1];
+  }
+
+  p_starts[0] = 0;
+
+  // Order buckets by descending size with a second counting sort
+  if ((p_positions = calloc(largest + 2, sizeof(unsigned long int))) == NULL) {
+    goto done;
+  }
+
+  for (counter = 0; counter < p_frozen->bucket_count; counter++) {
+    p_positions[largest - (p_starts[counter + 1] - p_starts[counter]) + 1]++;
+  }
+
+  for (counter = 0; counter <= largest; counter++) {
+    p_positions[counter + 1] += p_positions[counter];
+  }
+
+  for (counter = 0; counter < p_frozen->bucket_count; counter++) {
+    length = p_starts[counter + 1] - p_starts[counter];
+    p_order[p_positions[largest - length]++] = counter;
+  }
+
+  // Reuse the scratch array to hold the candidate slots of a single bucket
+  free(p_positions);
+
+  if ((p_positions = malloc(sizeof(unsigned long int) * (largest + 1))) ==
+      NULL) {
+    goto done;
+  }
+
+  for (counter = 0; counter < p_frozen->bucket_count; counter++) {
+    bucket = p_order[counter];
+    first = p_starts[bucket];
+    length = p_starts[bucket + 1] - first;
+    p_frozen->p_pilots[bucket] = 0;
+
+    if (length == 0) {
+      continue;
+    }
+
+    // Search for a pilot placing every key of this bucket in a free slot
+    for (pilot = 0; pilot < CH_FREEZE_TRIES; pilot++) {
+      for (member = 0; member < length; member++) {
+        slot = _slot(p_hashes[p_sorted[first + member]], pilot,
+          p_frozen->range);
+
+        if (p_taken[slot]) {
+          break;
+        }
+
+        p_taken[slot] = 1;
+        p_positions[member] = slot;
+      }
+
+      if (member == length) {
+        break;
+      }
+
+      // Roll back the slots claimed by this failed attempt
+      while (member > 0) {
+        p_taken[p_positions[--member]] = 0;
+      }
+    }
+
+    if (pilot == CH_FREEZE_TRIES) {
+      goto done;
+    }
+
+    p_frozen->p_pilots[bucket] = pilot;
+
+    for (member = 0; member < length; member++) {
+      p_frozen->p_slots[p_positions[member]].p_key =
+        p_keys[p_sorted[first + member]]->p_key;
+      p_frozen->p_slots[p_positions[member]].p_value =
+        p_keys[p_sorted[first + member]]->p_value;
+    }
+  }
+
+  // Move each key placed past the last slot into the next free slot
+  for (slot = p_frozen->size, member = 0; slot < p_frozen->range; slot++) {
+    p_frozen->p_remap[slot - p_frozen->size] = 0;
+
+    if (!p_taken[slot]) {
+      continue;
+    }
+
+    while (p_taken[member]) {
+      member++;
+    }
+
+    p_taken[member] = 1;
+    p_frozen->p_remap[slot - p_frozen->size] = member;
+    p_frozen->p_slots[member] = p_frozen->p_slots[slot];
+  }
+
+  placed = 1;
+
+done:
+  free(p_starts);
+  free(p_order);
+  free(p_sorted);
+  free(p_taken);
+  free(p_positions);
+
+  return placed;
+}
+
+/**
+ * @brief The <code>ch_freeze</code> function builds a <code>t_frozen</code>
+ * table holding every key/value pair currently stored in <code>p_table</code>.
+ * The keys are copied, so the source table may be modified or destroyed
+ * afterward; the values, being void pointers, are shared. Construction runs in
+ * expected linear time and is retried under a fresh seed on the rare occasion
+ * that a bucket cannot be placed.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @return t_frozen* A pointer to the frozen table, or <code>NULL</code>
+ */
+t_frozen * ch_freeze(t_table * p_table) {
+
+  // Declarations
+  t_frozen * p_frozen;
+  t_property ** p_keys, * p_entry;
+  t_slot * p_slots;
+  uint64_t * p_hashes;
+  unsigned long int counter, count, pool_length;
+  char * p_cursor;
+  int attempt;
+
+  // Definitions
+  count = 0;
+  pool_length = 0;
+
+  // Count the properties and the bytes needed to pool their keys
+  for (counter = 0; counter < p_table->size; counter++) {
+    for (p_entry = p_table->p_entries[counter]; p_entry != NULL;
+        p_entry = p_entry->p_next) {
+      pool_length += strlen(p_entry->p_key) + 1;
+      count++;
+    }
+  }
+
+  if ((p_frozen = calloc(1, sizeof(t_frozen))) == NULL) {
+    return NULL;
+  }
+
+  p_frozen->size = count;
+  p_frozen->range = count * 100 / CH_FREEZE_LOAD + 1;
+  p_frozen->bucket_count = count / CH_FREEZE_LAMBDA + 1;
+  p_frozen->p_pilots = malloc(sizeof(uint32_t) * p_frozen->bucket_count);
+  p_frozen->p_slots = calloc(p_frozen->range, sizeof(t_slot));
+  p_frozen->p_remap = malloc(sizeof(unsigned long int) *
+    (p_frozen->range - count));
+  p_frozen->p_pool = malloc(pool_length + 1);
+  p_keys = malloc(sizeof(t_property *) * (count + 1));
+  p_hashes = malloc(sizeof(uint64_t) * (count + 1));
+
+  if (!p_frozen->p_pilots || !p_frozen->p_slots || !p_frozen->p_remap ||
+      !p_frozen->p_pool || !p_keys || !p_hashes) {
+    free(p_keys);
+    free(p_hashes);
+    ch_frozen_destroy(p_frozen);
+    return NULL;
+  }
+
+  // Gather the properties and copy their keys into the pool
+  p_cursor = p_frozen->p_pool;
+  count = 0;
+
+  for (counter = 0; counter < p_table->size; counter++) {
+    for (p_entry = p_table->p_entries[counter]; p_entry != NULL;
+        p_entry = p_entry->p_next) {
+      p_keys[count++] = p_entry;
+    }
+  }
+
+  // Try successive seeds until every bucket receives a pilot
+  for (attempt = 0; attempt < CH_FREEZE_SEEDS; attempt++) {
+    p_frozen->seed = attempt;
+
+    if (count == 0 || _build(p_frozen, p_keys, p_hashes)) {
+      break;
+    }
+  }
+
+  // Redirect each slot's key from the source table into the pool
+  for (counter = 0; counter < count && attempt < CH_FREEZE_SEEDS; counter++) {
+    strcpy(p_cursor, p_frozen->p_slots[counter].p_key);
+    p_frozen->p_slots[counter].p_key = p_cursor;
+    p_cursor += strlen(p_cursor) + 1;
+  }
+
+  free(p_keys);
+  free(p_hashes);
+
+  if (attempt == CH_FREEZE_SEEDS) {
+    ch_frozen_destroy(p_frozen);
+    return NULL;
+  }
+
+  // Release the slots past the last, whose keys were all moved below it
+  if ((p_slots = realloc(p_frozen->p_slots, sizeof(t_slot) * (count + 1))) !=
+      NULL) {
+    p_frozen->p_slots = p_slots;
+  }
+
+  return p_frozen;
+}
+
+/**
+ * @brief The <code>ch_frozen_get</code> function is the frozen analogue of
+ * <code>ch_get</code>. Because the perfect hash maps every stored key to its
+ * own slot, there is no list to iterate; the single candidate slot, found
+ * through the remap array if the key's position lies past the last slot, is
+ * compared with <code>p_key</code> to reject keys that were never stored.
+ *
+ * @param p_frozen t_frozen* A pointer to the specific frozen table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_frozen_get(t_frozen * p_frozen, const char * p_key) {
+
+  // Declarations
+  uint64_t hash;
+  unsigned long int position;
+  t_slot * p_slot;
+
+  if (p_frozen->size == 0) {
+    return NULL;
+  }
+
+  // Definitions
+  hash = _hash(p_key, p_frozen->seed);
+  position = _slot(hash,
+    p_frozen->p_pilots[(hash >> 32) % p_frozen->bucket_count], p_frozen->range);
+
+  // Follow a position past the last slot to the slot its key was moved to
+  if (position >= p_frozen->size) {
+    position = p_frozen->p_remap[position - p_frozen->size];
+  }
+
+  p_slot = &p_frozen->p_slots[position];
+
+  return (strcmp(p_slot->p_key, p_key) == 0) ? p_slot->p_value : NULL;
+}
+
+/**
+ * @brief The <code>ch_frozen_destroy</code> function deallocates the pilot
+ * array, the slot array, the remap array and the key pool of
+ * <code>p_frozen</code>, then the frozen table itself.
+ *
+ * @param p_frozen t_frozen* A pointer to the specific frozen table
+ * @return void
+ */
+void ch_frozen_destroy(t_frozen * p_frozen) {
+
+  if (p_frozen == NULL) {
+    return;
+  }
+
+  free(p_frozen->p_pilots);
+  free(p_frozen->p_slots);
+  free(p_frozen->p_remap);
+  free(p_frozen->p_pool);
+  free(p_frozen);
+}
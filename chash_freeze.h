@@ -0,0 +1,86 @@
+/**
+ * @file chash_freeze.h
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Header file for immutable, minimal perfect hash CHash tables
+ */
+
+#ifndef __CHASH_FREEZE_H_
+#define __CHASH_FREEZE_H_
+
+#include <stdint.h>
+#include "chash.h"
+
+/**
+ * @brief The <code>t_slot</code> <code>struct</code> is a single entry of a
+ * frozen table. Unlike <code>t_property</code>, it has no <code>p_next</code>
+ * member, as a minimal perfect hash never places two keys in the same slot.
+ * The <code>p_key</code> member points into a string pool owned by the frozen
+ * table rather than into a separate allocation per key.
+ */
+typedef struct {
+  const char * p_key;           /**< Key string within the frozen key pool */
+  void * p_value;               /**< Void pointer representing the value */
+} t_slot;
+
+/**
+ * @brief The <code>t_frozen</code> <code>struct</code> is an immutable hash
+ * table built by <code>ch_freeze</code> using the "hash, displace and compress"
+ * family of minimal perfect hash constructions. Keys are distributed among
+ * <code>bucket_count</code> small buckets, and each bucket is assigned a pilot
+ * value such that its keys land in distinct positions among
+ * <code>range</code>, about one percent more positions than there are keys.
+ * The slot array nonetheless holds exactly <code>size</code> slots, one per
+ * key: the few keys whose positions lie past the last slot are stored in the
+ * slots left free, and <code>p_remap</code> maps each such position to its
+ * slot. A lookup therefore consists of a single hash, a single pilot read, at
+ * most one remap read, a single slot read and a single key comparison.
+ */
+typedef struct {
+  unsigned long int size;       /**< Number of keys and of slots */
+  unsigned long int range;      /**< Number of positions pilots map into */
+  unsigned long int bucket_count; /**< Number of pilot buckets */
+  uint64_t seed;                /**< Seed under which construction succeeded */
+  uint32_t * p_pilots;          /**< Displacement pilot for each bucket */
+  t_slot * p_slots;             /**< Exactly one slot per key */
+  unsigned long int * p_remap;  /**< Slot of each position past the last */
+  char * p_pool;                /**< Contiguous storage of all key strings */
+} t_frozen;
+
+/**
+ * @brief The <code>ch_freeze</code> function builds a <code>t_frozen</code>
+ * table holding every key/value pair currently stored in <code>p_table</code>.
+ * The keys are copied, so the source table may be modified or destroyed
+ * afterward; the values, being void pointers, are shared. Construction runs in
+ * expected linear time and is retried under a fresh seed on the rare occasion
+ * that a bucket cannot be placed.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @return t_frozen* A pointer to the frozen table, or <code>NULL</code>
+ */
+t_frozen * ch_freeze(t_table * p_table);
+
+/**
+ * @brief The <code>ch_frozen_get</code> function is the frozen analogue of
+ * <code>ch_get</code>. Because the perfect hash maps every stored key to its
+ * own slot, there is no list to iterate; the single candidate slot, found
+ * through the remap array if the key's position lies past the last slot, is
+ * compared with <code>p_key</code> to reject keys that were never stored.
+ *
+ * @param p_frozen t_frozen* A pointer to the specific frozen table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_frozen_get(t_frozen * p_frozen, const char * p_key);
+
+/**
+ * @brief The <code>ch_frozen_destroy</code> function deallocates the pilot
+ * array, the slot array, the remap array and the key pool of
+ * <code>p_frozen</code>, then the frozen table itself.
+ *
+ * @param p_frozen t_frozen* A pointer to the specific frozen table
+ * @return void
+ */
+void ch_frozen_destroy(t_frozen * p_frozen);
+
+#endif
@@ -0,0 +1,699 @@
+/**
+ * @file chash_hamt.c
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Source file for persistent CHash maps using a hash array mapped trie
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "chash_hamt.h"
+
+/**
+ * @brief Mask selecting a node position from the hash bits of one level
+ */
+#define CH_HAMT_MASK ((1U << CH_HAMT_BITS) - 1)
+
+/**
+ * @brief The <code>_mix</code> helper function passes a key's hash through the
+ * SplitMix64 finalizer to obtain its path through the trie. As
+ * <code>ch_hash</code> maps keys differing only in their final characters to
+ * nearby values, the raw hash would leave the upper levels of the trie nearly
+ * empty. The finalizer is a bijection, so two keys share a path in full only
+ * if their hashes are identical.
+ *
+ * @param hash unsigned long int The key's hash
+ * @return unsigned long int The key's path
+ */
+static unsigned long int _mix(unsigned long int hash) {
+  hash ^= hash >> 30;
+  hash *= 0xBF58476D1CE4E5B9UL;
+  hash ^= hash >> 27;
+  hash *= 0x94D049BB133111EBUL;
+  return hash ^ (hash >> 31);
+}
+
+/**
+ * @brief The <code>_popcount</code> helper function counts the bits set in
+ * <code>bits</code>, and so gives the index within a node of the entry at a
+ * position when passed the bitmap masked to the positions below it.
+ *
+ * @param bits uint32_t A bitmap
+ * @return unsigned int The number of bits set
+ */
+static unsigned int _popcount(uint32_t bits) {
+  bits = bits - ((bits >> 1) & 0x55555555U);
+  bits = (bits & 0x33333333U) + ((bits >> 2) & 0x33333333U);
+  bits = (bits + (bits >> 4)) & 0x0F0F0F0FU;
+  return (bits * 0x01010101U) >> 24;
+}
+
+/**
+ * @brief The <code>_leaf</code> helper function builds a leaf holding a copy of
+ * the key of <code>p_handle</code> and the value <code>p_value</code>, owned
+ * by the caller.
+ *
+ * @param p_handle const t_key* The pre-hashed key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return t_hamt_leaf* The leaf, or <code>NULL</code> if allocation failed
+ */
+static t_hamt_leaf * _leaf(const t_key * p_handle, void * p_value) {
+
+  // Declaration
+  t_hamt_leaf * p_leaf;
+
+  if ((p_leaf = malloc(sizeof(t_hamt_leaf) + p_handle->length + 1)) == NULL) {
+    return NULL;
+  }
+
+  p_leaf->refs = 1;
+  p_leaf->hash = p_handle->hash;
+  p_leaf->p_value = p_value;
+  p_leaf->p_next = NULL;
+  memcpy(p_leaf->key, p_handle->p_key, p_handle->length + 1);
+
+  return p_leaf;
+}
+
+/**
+ * @brief The <code>_release_leaf</code> helper function drops one reference
+ * to the chain of leaves headed by <code>p_leaf</code>, deallocating each leaf
+ * in turn whose last reference that was.
+ *
+ * @param p_leaf t_hamt_leaf* The head of the chain, or <code>NULL</code>
+ * @return void
+ */
+static void _release_leaf(t_hamt_leaf * p_leaf) {
+
+  // Declaration
+  t_hamt_leaf * p_next;
+
+  while (p_leaf != NULL && --p_leaf->refs == 0) {
+    p_next = p_leaf->p_next;
+    free(p_leaf);
+    p_leaf = p_next;
+  }
+}
+
+/**
+ * @brief The <code>_release_node</code> helper function drops one reference
+ * to <code>p_node</code>, deallocating it along with everything it alone
+ * refers to if that was its last.
+ *
+ * @param p_node t_hamt_node* The node, or <code>NULL</code>
+ * @return void
+ */
+static void _release_node(t_hamt_node * p_node) {
+
+  // Declarations
+  unsigned int leaves, entries, counter;
+
+  if (p_node == NULL || --p_node->refs != 0) {
+    return;
+  }
+
+  // Definitions
+  leaves = _popcount(p_node->datamap);
+  entries = leaves + _popcount(p_node->nodemap);
+
+  for (counter = 0; counter < entries; counter++) {
+    if (counter < leaves) {
+      _release_leaf(p_node->p_slots[counter]);
+    } else {
+      _release_node(p_node->p_slots[counter]);
+    }
+  }
+
+  free(p_node);
+}
+
+/**
+ * @brief The <code>_build</code> helper function allocates a node with the
+ * given bitmaps, holding <code>p_leaves</code> and <code>p_children</code>,
+ * and takes a reference to each. The caller's own references are untouched.
+ *
+ * @param datamap uint32_t Positions holding a leaf
+ * @param nodemap uint32_t Positions holding a child node
+ * @param p_leaves void** One leaf chain per bit of <code>datamap</code>
+ * @param p_children void** One child per bit of <code>nodemap</code>
+ * @return t_hamt_node* The node, or <code>NULL</code> if allocation failed
+ */
+static t_hamt_node * _build(uint32_t datamap, uint32_t nodemap,
+    void ** p_leaves, void ** p_children) {
+
+  // Declarations
+  t_hamt_node * p_node;
+  unsigned int leaves, children, counter;
+
+  // Definitions
+  leaves = _popcount(datamap);
+  children = _popcount(nodemap);
+
+  if ((p_node = malloc(sizeof(t_hamt_node) + sizeof(void *) * (leaves +
+      children))) == NULL) {
+    return NULL;
+  }
+
+  p_node->refs = 1;
+  p_node->datamap = datamap;
+  p_node->nodemap = nodemap;
+
+  for (counter = 0; counter < leaves; counter++) {
+    p_node->p_slots[counter] = p_leaves[counter];
+    ((t_hamt_leaf *) p_leaves[counter])->refs++;
+  }
+
+  for (counter = 0; counter < children; counter++) {
+    p_node->p_slots[leaves + counter] = p_children[counter];
+    ((t_hamt_node *) p_children[counter])->refs++;
+  }
+
+  return p_node;
+}
+
+/**
+ * @brief The <code>_split</code> helper function copies the entries of
+ * <code>p_node</code>, if any, into <code>p_leaves</code> and
+ * <code>p_children</code>, each of which must hold 32 pointers, so that a
+ * modified copy of the node can be assembled and passed to
+ * <code>_build</code>.
+ *
+ * @param p_node const t_hamt_node* The node, or <code>NULL</code>
+ * @param p_leaves void** Receives the node's leaf chains
+ * @param p_children void** Receives the node's children
+ * @return void
+ */
+static void _split(const t_hamt_node * p_node, void ** p_leaves,
+    void ** p_children) {
+
+  // Declaration
+  unsigned int leaves;
+
+  if (p_node != NULL) {
+    leaves = _popcount(p_node->datamap);
+    memcpy(p_leaves, p_node->p_slots, sizeof(void *) * leaves);
+    memcpy(p_children, p_node->p_slots + leaves, sizeof(void *) *
+      _popcount(p_node->nodemap));
+  }
+}
+
+/**
+ * @brief The <code>_insert</code> helper function inserts <code>p_entry</code>
+ * at <code>index</code> of an array currently holding <code>length</code>
+ * entries, or removes the entry at <code>index</code> if <code>p_entry</code>
+ * is <code>NULL</code>.
+ *
+ * @param p_array void** The array
+ * @param length unsigned int Number of entries before the change
+ * @param index unsigned int Index at which to insert or remove
+ * @param p_entry void* The entry to insert, or <code>NULL</code> to remove
+ * @return void
+ */
+static void _insert(void ** p_array, unsigned int length, unsigned int index,
+    void * p_entry) {
+  if (p_entry != NULL) {
+    memmove(p_array + index + 1, p_array + index, sizeof(void *) *
+      (length - index));
+    p_array[index] = p_entry;
+  } else {
+    memmove(p_array + index, p_array + index + 1, sizeof(void *) *
+      (length - index - 1));
+  }
+}
+
+/**
+ * @brief The <code>_without</code> helper function returns a chain holding the
+ * leaves of <code>p_chain</code> other than that keyed <code>p_key</code>,
+ * owned by the caller. If the key is absent, the chain itself is returned with
+ * a new reference; otherwise the leaves kept are copied, since leaves are
+ * never modified.
+ *
+ * @param p_chain t_hamt_leaf* The chain, whose leaves share one hash
+ * @param p_key const char* A string representing the key to be left out
+ * @param p_found int* Set to 1 if the key was in the chain, else 0
+ * @param p_failed int* Set to 1 if allocation failed, else 0
+ * @return t_hamt_leaf* The new chain, or <code>NULL</code> if empty or failed
+ */
+static t_hamt_leaf * _without(t_hamt_leaf * p_chain, const char * p_key,
+    int * p_found, int * p_failed) {
+
+  // Declarations
+  t_hamt_leaf * p_leaf, * p_head, * p_copy;
+  t_key handle;
+
+  // Definitions
+  *p_found = 0;
+  *p_failed = 0;
+  p_head = NULL;
+
+  for (p_leaf = p_chain; p_leaf != NULL; p_leaf = p_leaf->p_next) {
+    if (strcmp(p_leaf->key, p_key) == 0) {
+      *p_found = 1;
+      continue;
+    }
+
+    handle.p_key = p_leaf->key;
+    handle.length = strlen(p_leaf->key);
+    handle.hash = p_leaf->hash;
+
+    if ((p_copy = _leaf(&handle, p_leaf->p_value)) == NULL) {
+      _release_leaf(p_head);
+      *p_failed = 1;
+      return NULL;
+    }
+
+    p_copy->p_next = p_head;
+    p_head = p_copy;
+  }
+
+  if (!*p_found) {
+    _release_leaf(p_head);
+    p_chain->refs++;
+    return p_chain;
+  }
+
+  return p_head;
+}
+
+/**
+ * @brief The <code>_pair</code> helper function builds the subtrie holding the
+ * leaf chains <code>p_first</code> and <code>p_second</code>, whose hashes
+ * differ, below level <code>shift</code>. Nodes holding a single child are
+ * built for as many levels as the two paths agree.
+ *
+ * @param p_first t_hamt_leaf* The first chain
+ * @param p_second t_hamt_leaf* The second chain
+ * @param shift unsigned int Hash bits consumed above the subtrie
+ * @return t_hamt_node* The subtrie, or <code>NULL</code> if allocation failed
+ */
+static t_hamt_node * _pair(t_hamt_leaf * p_first, t_hamt_leaf * p_second,
+    unsigned int shift) {
+
+  // Declarations
+  unsigned int first, second;
+  void * p_entries[2];
+  t_hamt_node * p_child, * p_node;
+
+  // Definitions
+  first = (_mix(p_first->hash) >> shift) & CH_HAMT_MASK;
+  second = (_mix(p_second->hash) >> shift) & CH_HAMT_MASK;
+
+  if (first == second) {
+    if ((p_child = _pair(p_first, p_second, shift + CH_HAMT_BITS)) == NULL) {
+      return NULL;
+    }
+
+    p_entries[0] = p_child;
+    p_node = _build(0, 1U << first, NULL, p_entries);
+    _release_node(p_child);
+
+    return p_node;
+  }
+
+  p_entries[first > second] = p_first;
+  p_entries[first < second] = p_second;
+
+  return _build((1U << first) | (1U << second), 0, p_entries, NULL);
+}
+
+/**
+ * @brief The <code>_put</code> helper function returns a copy of the subtrie
+ * <code>p_node</code>, at level <code>shift</code>, in which the key of
+ * <code>p_new</code> maps to its value. Only the nodes on the key's path are
+ * copied. The caller keeps its reference to <code>p_new</code>.
+ *
+ * @param p_node const t_hamt_node* The subtrie, or <code>NULL</code> if empty
+ * @param shift unsigned int Hash bits consumed above the subtrie
+ * @param p_new t_hamt_leaf* The new leaf
+ * @param p_added int* Set to 1 if the key was not already present
+ * @return t_hamt_node* The new subtrie, or <code>NULL</code> on failure
+ */
+static t_hamt_node * _put(const t_hamt_node * p_node, unsigned int shift,
+    t_hamt_leaf * p_new, int * p_added) {
+
+  // Declarations
+  void * p_leaves[1U << CH_HAMT_BITS], * p_children[1U << CH_HAMT_BITS];
+  uint32_t datamap, nodemap, bit;
+  unsigned int leaf, child;
+  t_hamt_leaf * p_chain;
+  t_hamt_node * p_child, * p_result;
+  int found, failed;
+
+  // Definitions
+  datamap = (p_node != NULL) ? p_node->datamap : 0;
+  nodemap = (p_node != NULL) ? p_node->nodemap : 0;
+  bit = 1U << ((_mix(p_new->hash) >> shift) & CH_HAMT_MASK);
+  leaf = _popcount(datamap & (bit - 1));
+  child = _popcount(nodemap & (bit - 1));
+  _split(p_node, p_leaves, p_children);
+
+  // Descend into the child at the key's position
+  if (nodemap & bit) {
+    if ((p_child = _put(p_children[child], shift + CH_HAMT_BITS, p_new,
+        p_added)) == NULL) {
+      return NULL;
+    }
+
+    p_children[child] = p_child;
+    p_result = _build(datamap, nodemap, p_leaves, p_children);
+    _release_node(p_child);
+
+    return p_result;
+  }
+
+  // Claim a free position
+  if (!(datamap & bit)) {
+    *p_added = 1;
+    _insert(p_leaves, _popcount(datamap), leaf, p_new);
+
+    return _build(datamap | bit, nodemap, p_leaves, p_children);
+  }
+
+  p_chain = p_leaves[leaf];
+
+  // Push a leaf with another hash down into a new child alongside the key
+  if (p_chain->hash != p_new->hash) {
+    if ((p_child = _pair(p_chain, p_new, shift + CH_HAMT_BITS)) == NULL) {
+      return NULL;
+    }
+
+    *p_added = 1;
+    _insert(p_leaves, _popcount(datamap), leaf, NULL);
+    _insert(p_children, _popcount(nodemap), child, p_child);
+    p_result = _build(datamap & ~bit, nodemap | bit, p_leaves, p_children);
+    _release_node(p_child);
+
+    return p_result;
+  }
+
+  // Replace a leaf with an identical hash, chaining any with other keys
+  p_new->p_next = _without(p_chain, p_new->key, &found, &failed);
+
+  if (failed) {
+    return NULL;
+  }
+
+  *p_added = !found;
+  p_leaves[leaf] = p_new;
+
+  return _build(datamap, nodemap, p_leaves, p_children);
+}
+
+/**
+ * @brief The <code>_delete</code> helper function derives from the subtrie
+ * <code>p_node</code>, at level <code>shift</code>, a subtrie without the key
+ * of <code>p_handle</code>, whose path is <code>path</code>. A child left
+ * holding a single leaf chain is folded into the new node.
+ *
+ * @param p_node const t_hamt_node* The subtrie
+ * @param shift unsigned int Hash bits consumed above the subtrie
+ * @param p_handle const t_key* The pre-hashed key to be removed
+ * @param path unsigned long int The key's path, as given by <code>_mix</code>
+ * @param p_result t_hamt_node** Receives the new subtrie, or <code>NULL</code>
+ * if it would be empty
+ * @return int 1 if the key was removed, 0 if absent, -1 on failure
+ */
+static int _delete(const t_hamt_node * p_node, unsigned int shift,
+    const t_key * p_handle, unsigned long int path, t_hamt_node ** p_result) {
+
+  // Declarations
+  void * p_leaves[1U << CH_HAMT_BITS], * p_children[1U << CH_HAMT_BITS];
+  uint32_t datamap, nodemap, bit;
+  unsigned int leaf, child;
+  t_hamt_leaf * p_chain;
+  t_hamt_node * p_child;
+  int found, failed, status;
+
+  // Definitions
+  datamap = p_node->datamap;
+  nodemap = p_node->nodemap;
+  bit = 1U << ((path >> shift) & CH_HAMT_MASK);
+  leaf = _popcount(datamap & (bit - 1));
+  child = _popcount(nodemap & (bit - 1));
+  p_chain = NULL;
+  p_child = NULL;
+  _split(p_node, p_leaves, p_children);
+
+  if (datamap & bit) {
+    if (((t_hamt_leaf *) p_leaves[leaf])->hash != p_handle->hash) {
+      return 0;
+    }
+
+    p_chain = _without(p_leaves[leaf], p_handle->p_key, &found, &failed);
+
+    if (failed || !found) {
+      _release_leaf(p_chain);
+      return failed ? -1 : 0;
+    }
+
+    if (p_chain != NULL) {
+      p_leaves[leaf] = p_chain;
+    } else {
+      _insert(p_leaves, _popcount(datamap), leaf, NULL);
+      datamap &= ~bit;
+    }
+  } else if (nodemap & bit) {
+    if ((status = _delete(p_children[child], shift + CH_HAMT_BITS, p_handle,
+        path, &p_child)) != 1) {
+      return status;
+    }
+
+    // Fold a child holding one chain, or none, into this node
+    if (p_child == NULL || (p_child->nodemap == 0 &&
+        _popcount(p_child->datamap) == 1)) {
+      _insert(p_children, _popcount(nodemap), child, NULL);
+      nodemap &= ~bit;
+
+      if (p_child != NULL) {
+        _insert(p_leaves, _popcount(datamap), leaf, p_child->p_slots[0]);
+        datamap |= bit;
+      }
+    } else {
+      p_children[child] = p_child;
+    }
+  } else {
+    return 0;
+  }
+
+  *p_result = (datamap | nodemap) ? _build(datamap, nodemap, p_leaves,
+    p_children) : NULL;
+  _release_leaf(p_chain);
+  _release_node(p_child);
+
+  return ((datamap | nodemap) && *p_result == NULL) ? -1 : 1;
+}
+
+/**
+ * @brief The <code>_version</code> helper function allocates a version holding
+ * <code>count</code> pairs under <code>p_root</code>, taking over the
+ * caller's reference to the root.
+ *
+ * @param p_root t_hamt_node* The root, or <code>NULL</code>
+ * @param count unsigned long int Number of key/value pairs
+ * @return t_hamt* The version, or <code>NULL</code> if allocation failed
+ */
+static t_hamt * _version(t_hamt_node * p_root, unsigned long int count) {
+
+  // Declaration
+  t_hamt * p_hamt;
+
+  if ((p_hamt = malloc(sizeof(t_hamt))) == NULL) {
+    _release_node(p_root);
+    return NULL;
+  }
+
+  p_hamt->count = count;
+  p_hamt->p_root = p_root;
+
+  return p_hamt;
+}
+
+/**
+ * @brief The <code>ch_hamt_create</code> function constructs an empty map, the
+ * version from which all others are derived.
+ *
+ * @return t_hamt* A pointer to the empty version, or <code>NULL</code>
+ */
+t_hamt * ch_hamt_create(void) {
+  return _version(NULL, 0);
+}
+
+/**
+ * @brief The <code>ch_hamt_put</code> function returns a new version of
+ * <code>p_hamt</code> in which <code>p_key</code> maps to
+ * <code>p_value</code>. The version given is left unchanged and must still be
+ * released by its owner.
+ *
+ * @param p_hamt const t_hamt* A pointer to the version to derive from
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return t_hamt* The new version, or <code>NULL</code> if allocation failed
+ */
+t_hamt * ch_hamt_put(const t_hamt * p_hamt, const char * p_key,
+    void * p_value) {
+
+  // Declaration
+  t_key handle;
+
+  // Definition
+  handle = ch_key(p_key);
+
+  return ch_hamt_put_h(p_hamt, &handle, p_value);
+}
+
+/**
+ * @brief The <code>ch_hamt_put_h</code> function behaves exactly as
+ * <code>ch_hamt_put</code>, save that the key is supplied as a pre-hashed
+ * <code>t_key</code> handle.
+ *
+ * @param p_hamt const t_hamt* A pointer to the version to derive from
+ * @param p_handle const t_key* The pre-hashed key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return t_hamt* The new version, or <code>NULL</code> if allocation failed
+ */
+t_hamt * ch_hamt_put_h(const t_hamt * p_hamt, const t_key * p_handle,
+    void * p_value) {
+
+  // Declarations
+  t_hamt_leaf * p_leaf;
+  t_hamt_node * p_root;
+  int added;
+
+  // Definitions
+  added = 0;
+
+  if ((p_leaf = _leaf(p_handle, p_value)) == NULL) {
+    return NULL;
+  }
+
+  p_root = _put(p_hamt->p_root, 0, p_leaf, &added);
+  _release_leaf(p_leaf);
+
+  if (p_root == NULL) {
+    return NULL;
+  }
+
+  return _version(p_root, p_hamt->count + added);
+}
+
+/**
+ * @brief The <code>ch_hamt_get</code> function retrieves the value mapped to
+ * <code>p_key</code> in the version <code>p_hamt</code>, descending one level
+ * of the trie per <code>CH_HAMT_BITS</code> bits of the key's hash.
+ *
+ * @param p_hamt const t_hamt* A pointer to the version
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_hamt_get(const t_hamt * p_hamt, const char * p_key) {
+
+  // Declaration
+  t_key handle;
+
+  // Definition
+  handle = ch_key(p_key);
+
+  return ch_hamt_get_h(p_hamt, &handle);
+}
+
+/**
+ * @brief The <code>ch_hamt_get_h</code> function behaves exactly as
+ * <code>ch_hamt_get</code>, save that the key is supplied as a pre-hashed
+ * <code>t_key</code> handle.
+ *
+ * @param p_hamt const t_hamt* A pointer to the version
+ * @param p_handle const t_key* The pre-hashed key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_hamt_get_h(const t_hamt * p_hamt, const t_key * p_handle) {
+
+  // Declarations
+  const t_hamt_node * p_node;
+  t_hamt_leaf * p_leaf;
+  unsigned long int path;
+  unsigned int shift;
+  uint32_t bit;
+
+  // Definitions
+  p_node = p_hamt->p_root;
+  path = _mix(p_handle->hash);
+
+  for (shift = 0; p_node != NULL; shift += CH_HAMT_BITS) {
+    bit = 1U << ((path >> shift) & CH_HAMT_MASK);
+
+    if (p_node->nodemap & bit) {
+      p_node = p_node->p_slots[_popcount(p_node->datamap) +
+        _popcount(p_node->nodemap & (bit - 1))];
+      continue;
+    }
+
+    if (!(p_node->datamap & bit)) {
+      return NULL;
+    }
+
+    for (p_leaf = p_node->p_slots[_popcount(p_node->datamap & (bit - 1))];
+        p_leaf != NULL; p_leaf = p_leaf->p_next) {
+      if (p_leaf->hash == p_handle->hash &&
+          strcmp(p_leaf->key, p_handle->p_key) == 0) {
+        return p_leaf->p_value;
+      }
+    }
+
+    return NULL;
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief The <code>ch_hamt_delete</code> function returns a new version of
+ * <code>p_hamt</code> without <code>p_key</code>. A node left holding a single
+ * leaf is folded into its parent, so that every version stays as shallow as
+ * if it had been built without the key. If the key is absent, the new version
+ * simply shares the old version's root.
+ *
+ * @param p_hamt const t_hamt* A pointer to the version to derive from
+ * @param p_key const char* A string representing the key to be removed
+ * @return t_hamt* The new version, or <code>NULL</code> if allocation failed
+ */
+t_hamt * ch_hamt_delete(const t_hamt * p_hamt, const char * p_key) {
+
+  // Declarations
+  t_key handle;
+  t_hamt_node * p_root;
+  int status;
+
+  // Definitions
+  handle = ch_key(p_key);
+  status = (p_hamt->p_root != NULL) ? _delete(p_hamt->p_root, 0, &handle,
+    _mix(handle.hash), &p_root) : 0;
+
+  if (status == -1) {
+    return NULL;
+  }
+
+  if (status == 0) {
+    if ((p_root = p_hamt->p_root) != NULL) {
+      p_root->refs++;
+    }
+
+    return _version(p_root, p_hamt->count);
+  }
+
+  return _version(p_root, p_hamt->count - 1);
+}
+
+/**
+ * @brief The <code>ch_hamt_release</code> function releases the version
+ * <code>p_hamt</code>, deallocating every node and leaf no other live version
+ * shares. Values are the caller's and are not released.
+ *
+ * @param p_hamt t_hamt* A pointer to the version to be released
+ * @return void
+ */
+void ch_hamt_release(t_hamt * p_hamt) {
+  if (p_hamt != NULL) {
+    _release_node(p_hamt->p_root);
+    free(p_hamt);
+  }
+}
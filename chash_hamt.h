@@ -0,0 +1,151 @@
+/**
+ * @file chash_hamt.h
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Header file for persistent CHash maps using a hash array mapped trie
+ */
+
+#ifndef __CHASH_HAMT_H_
+#define __CHASH_HAMT_H_
+
+#include <stdint.h>
+#include "chash.h"
+
+/**
+ * @brief Number of hash bits consumed at each level of the trie, such that
+ * each node has at most <code>1 << CH_HAMT_BITS</code> entries
+ */
+#define CH_HAMT_BITS 5
+
+/**
+ * @brief The <code>s_hamt_leaf</code> <code>struct</code> holds one key/value
+ * pair, followed directly by its key string. Leaves are shared between every
+ * version in which the pair is unchanged, and are never modified once built.
+ * Keys whose hashes are identical in full are chained through
+ * <code>p_next</code>.
+ */
+typedef struct s_hamt_leaf {
+  unsigned long int refs;       /**< Number of nodes and leaves referring */
+  unsigned long int hash;       /**< Cached hash of the key string */
+  void * p_value;               /**< Void pointer representing the value */
+  struct s_hamt_leaf * p_next;  /**< Next leaf with an identical hash */
+  char key[];                   /**< Key string, including its terminator */
+} t_hamt_leaf;
+
+/**
+ * @brief The <code>s_hamt_node</code> <code>struct</code> is one node of the
+ * trie. Of the 32 positions a node may hold at its level, it stores only those
+ * in use, in the flexible array <code>p_slots</code>: first a leaf for each bit
+ * set in <code>datamap</code>, then a child node for each bit set in
+ * <code>nodemap</code>, in bit order. The index of a position's entry is thus
+ * the number of lower bits set, as counted by a population count. Like leaves,
+ * nodes are shared between versions and never modified once built.
+ */
+typedef struct s_hamt_node {
+  unsigned long int refs;       /**< Number of versions and nodes referring */
+  uint32_t datamap;             /**< Positions holding a leaf */
+  uint32_t nodemap;             /**< Positions holding a child node */
+  void * p_slots[];             /**< Leaves, then child nodes */
+} t_hamt_node;
+
+/**
+ * @brief The <code>t_hamt</code> <code>struct</code> is one version of a
+ * persistent map. A version is never modified: <code>ch_hamt_put</code> and
+ * <code>ch_hamt_delete</code> instead return a new version, which copies only
+ * the nodes on the path to the key changed and shares every other node and
+ * leaf with the version it was derived from. Any number of versions may thus
+ * be kept alive at the cost of a few nodes each. Keys are hashed by
+ * <code>ch_hash</code>, so <code>t_key</code> handles built by
+ * <code>ch_key</code> serve here as they do for a <code>t_table</code>.
+ * <br />
+ * <br />
+ * Lookups never write to shared memory and may run concurrently with anything
+ * but the release of the version being read. Deriving and releasing versions
+ * adjusts reference counts without atomics, so must not run concurrently.
+ */
+typedef struct {
+  unsigned long int count;      /**< Number of key/value pairs stored */
+  t_hamt_node * p_root;         /**< Root node, or NULL if empty */
+} t_hamt;
+
+/**
+ * @brief The <code>ch_hamt_create</code> function constructs an empty map, the
+ * version from which all others are derived.
+ *
+ * @return t_hamt* A pointer to the empty version, or <code>NULL</code>
+ */
+t_hamt * ch_hamt_create(void);
+
+/**
+ * @brief The <code>ch_hamt_put</code> function returns a new version of
+ * <code>p_hamt</code> in which <code>p_key</code> maps to
+ * <code>p_value</code>. The version given is left unchanged and must still be
+ * released by its owner.
+ *
+ * @param p_hamt const t_hamt* A pointer to the version to derive from
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return t_hamt* The new version, or <code>NULL</code> if allocation failed
+ */
+t_hamt * ch_hamt_put(const t_hamt * p_hamt, const char * p_key,
+  void * p_value);
+
+/**
+ * @brief The <code>ch_hamt_put_h</code> function behaves exactly as
+ * <code>ch_hamt_put</code>, save that the key is supplied as a pre-hashed
+ * <code>t_key</code> handle.
+ *
+ * @param p_hamt const t_hamt* A pointer to the version to derive from
+ * @param p_handle const t_key* The pre-hashed key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return t_hamt* The new version, or <code>NULL</code> if allocation failed
+ */
+t_hamt * ch_hamt_put_h(const t_hamt * p_hamt, const t_key * p_handle,
+  void * p_value);
+
+/**
+ * @brief The <code>ch_hamt_get</code> function retrieves the value mapped to
+ * <code>p_key</code> in the version <code>p_hamt</code>, descending one level
+ * of the trie per <code>CH_HAMT_BITS</code> bits of the key's hash.
+ *
+ * @param p_hamt const t_hamt* A pointer to the version
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_hamt_get(const t_hamt * p_hamt, const char * p_key);
+
+/**
+ * @brief The <code>ch_hamt_get_h</code> function behaves exactly as
+ * <code>ch_hamt_get</code>, save that the key is supplied as a pre-hashed
+ * <code>t_key</code> handle.
+ *
+ * @param p_hamt const t_hamt* A pointer to the version
+ * @param p_handle const t_key* The pre-hashed key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_hamt_get_h(const t_hamt * p_hamt, const t_key * p_handle);
+
+/**
+ * @brief The <code>ch_hamt_delete</code> function returns a new version of
+ * <code>p_hamt</code> without <code>p_key</code>. A node left holding a single
+ * leaf is folded into its parent, so that every version stays as shallow as
+ * if it had been built without the key. If the key is absent, the new version
+ * simply shares the old version's root.
+ *
+ * @param p_hamt const t_hamt* A pointer to the version to derive from
+ * @param p_key const char* A string representing the key to be removed
+ * @return t_hamt* The new version, or <code>NULL</code> if allocation failed
+ */
+t_hamt * ch_hamt_delete(const t_hamt * p_hamt, const char * p_key);
+
+/**
+ * @brief The <code>ch_hamt_release</code> function releases the version
+ * <code>p_hamt</code>, deallocating every node and leaf no other live version
+ * shares. Values are the caller's and are not released.
+ *
+ * @param p_hamt t_hamt* A pointer to the version to be released
+ * @return void
+ */
+void ch_hamt_release(t_hamt * p_hamt);
+
+#endif
@@ -0,0 +1,368 @@
+/**
+ * @file chash_hopscotch.c
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Source file for CHash tables using hopscotch hashing
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "chash.h"
+#include "chash_hopscotch.h"
+
+/**
+ * @brief Furthest distance from its home slot at which a new key's free slot
+ * is sought before the table is judged too full and doubled
+ */
+#define CH_HOPSCOTCH_PROBE 1024
+
+/**
+ * @brief The <code>_home</code> helper function returns the home slot of a key
+ * whose hash is <code>hash</code>. The hash is first passed through the
+ * SplitMix64 finalizer, because <code>ch_hash</code> maps keys differing only
+ * in their final characters, such as sequential identifiers, to consecutive
+ * values. Chaining tolerates such runs, but open addressing would see them
+ * pile up in a single stretch of neighborhoods and force needless growth.
+ *
+ * @param hash unsigned long int The key's hash
+ * @param size unsigned long int Number of slots
+ * @return unsigned long int The index of the key's home slot
+ */
+static unsigned long int _home(unsigned long int hash, unsigned long int size) {
+  hash ^= hash >> 30;
+  hash *= 0xBF58476D1CE4E5B9UL;
+  hash ^= hash >> 27;
+  hash *= 0x94D049BB133111EBUL;
+  return (hash ^ (hash >> 31)) % size;
+}
+
+/**
+ * @brief The <code>_find</code> helper function returns the slot holding the
+ * key <code>p_key</code>, whose hash is <code>hash</code>, by visiting each
+ * slot marked in the bitmap of the key's home slot.
+ *
+ * @param p_table t_hopscotch* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key
+ * @param hash unsigned long int The key's hash
+ * @return t_hop_slot* The slot holding the key, or <code>NULL</code>
+ */
+static t_hop_slot * _find(t_hopscotch * p_table, const char * p_key,
+    unsigned long int hash) {
+
+  // Declarations
+  unsigned long int home, offset;
+  uint32_t bits;
+  t_hop_slot * p_slot;
+
+  // Definitions
+  home = _home(hash, p_table->size);
+  bits = p_table->p_slots[home].hop;
+
+  for (offset = 0; bits != 0; offset++, bits >>= 1) {
+    if ((bits & 1) == 0) {
+      continue;
+    }
+
+    p_slot = &p_table->p_slots[(home + offset) % p_table->size];
+
+    if (p_slot->hash == hash && strcmp(p_slot->p_key, p_key) == 0) {
+      return p_slot;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief The <code>_insert</code> helper function places an already allocated
+ * key, its value and its hash in the slot array <code>p_slots</code> of
+ * <code>size</code> slots. Positions are tracked as distances past the home
+ * slot and reduced modulo <code>size</code> only when indexing, so that
+ * neighborhoods wrap around the end of the array. The function fails without
+ * modifying the array if no free slot is near enough, and may fail having
+ * hopped some keys forward, which leaves the array valid but rearranged.
+ *
+ * @param p_slots t_hop_slot* The slot array receiving the pair
+ * @param size unsigned long int Number of slots in the array
+ * @param p_key char* The key string, whose ownership passes to the table
+ * @param p_value void* A void pointer to the address of the associated value
+ * @param hash unsigned long int The key's hash
+ * @return int 1 if the pair was placed, otherwise 0
+ */
+static int _insert(t_hop_slot * p_slots, unsigned long int size, char * p_key,
+    void * p_value, unsigned long int hash) {
+
+  // Declarations
+  unsigned long int home, vacant, candidate, offset;
+  t_hop_slot * p_from, * p_to;
+
+  // Definitions
+  home = _home(hash, size);
+  offset = 0;
+
+  // Find the nearest free slot at or after the home slot
+  for (vacant = home; vacant - home < size &&
+      vacant - home < CH_HOPSCOTCH_PROBE; vacant++) {
+    if (p_slots[vacant % size].p_key == NULL) {
+      break;
+    }
+  }
+
+  if (vacant - home == size || vacant - home == CH_HOPSCOTCH_PROBE) {
+    return 0;
+  }
+
+  // Hop the free slot backward until it lies within the neighborhood
+  while (vacant - home >= CH_HOPSCOTCH_RANGE) {
+    for (candidate = vacant - (CH_HOPSCOTCH_RANGE - 1); candidate < vacant;
+        candidate++) {
+      for (offset = 0; candidate + offset < vacant; offset++) {
+        if (p_slots[candidate % size].hop & ((uint32_t) 1 << offset)) {
+          break;
+        }
+      }
+
+      if (candidate + offset < vacant) {
+        break;
+      }
+    }
+
+    // No key between here and the free slot may legally move into it
+    if (candidate == vacant) {
+      return 0;
+    }
+
+    // Move the candidate bucket's key forward into the free slot
+    p_from = &p_slots[(candidate + offset) % size];
+    p_to = &p_slots[vacant % size];
+    p_to->p_key = p_from->p_key;
+    p_to->p_value = p_from->p_value;
+    p_to->hash = p_from->hash;
+    p_from->p_key = NULL;
+
+    p_slots[candidate % size].hop &= ~((uint32_t) 1 << offset);
+    p_slots[candidate % size].hop |= (uint32_t) 1 << (vacant - candidate);
+    vacant = candidate + offset;
+  }
+
+  p_to = &p_slots[vacant % size];
+  p_to->p_key = p_key;
+  p_to->p_value = p_value;
+  p_to->hash = hash;
+  p_slots[home].hop |= (uint32_t) 1 << (vacant - home);
+
+  return 1;
+}
+
+/**
+ * @brief The <code>_grow</code> helper function doubles the slot array and
+ * reinserts every pair using its cached hash. If a pair cannot be placed in
+ * the doubled array, the array is discarded and a larger one tried; the old
+ * array is untouched until every pair has been placed.
+ *
+ * @param p_table t_hopscotch* A pointer to the specific hash table
+ * @return int 1 on success, 0 if allocation failed
+ */
+static int _grow(t_hopscotch * p_table) {
+
+  // Declarations
+  t_hop_slot * p_slots, * p_slot;
+  unsigned long int size, counter;
+
+  for (size = p_table->size * 2; ; size *= 2) {
+    if ((p_slots = calloc(size, sizeof(t_hop_slot))) == NULL) {
+      return 0;
+    }
+
+    for (counter = 0; counter < p_table->size; counter++) {
+      p_slot = &p_table->p_slots[counter];
+
+      if (p_slot->p_key != NULL &&
+          !_insert(p_slots, size, p_slot->p_key, p_slot->p_value,
+            p_slot->hash)) {
+        break;
+      }
+    }
+
+    if (counter == p_table->size) {
+      break;
+    }
+
+    free(p_slots);
+  }
+
+  free(p_table->p_slots);
+  p_table->p_slots = p_slots;
+  p_table->size = size;
+
+  return 1;
+}
+
+/**
+ * @brief The <code>ch_hopscotch_create</code> function constructs an empty
+ * hopscotch table of <code>table_size</code> slots. The table grows whenever
+ * a key cannot be placed within its neighborhood, so the size given is only a
+ * starting point.
+ *
+ * @param table_size unsigned long int Initial number of slots
+ * @return t_hopscotch* A pointer to the specific hash table
+ */
+t_hopscotch * ch_hopscotch_create(unsigned long int table_size) {
+
+  // Declaration
+  t_hopscotch * p_table;
+
+  if ((p_table = malloc(sizeof(t_hopscotch))) == NULL) {
+    return NULL;
+  }
+
+  p_table->size = (table_size > 0) ? table_size : 1;
+  p_table->count = 0;
+
+  if ((p_table->p_slots = calloc(p_table->size, sizeof(t_hop_slot))) == NULL) {
+    free(p_table);
+    return NULL;
+  }
+
+  return p_table;
+}
+
+/**
+ * @brief The <code>ch_hopscotch_put</code> function maps <code>p_key</code> to
+ * <code>p_value</code>, updating the value if the key is already present, as
+ * <code>ch_put</code> does. A new key takes the nearest free slot at or after
+ * its home. If that slot lies outside the neighborhood, keys between the two
+ * are hopped forward into it, each staying within its own neighborhood, until
+ * the free slot is brought close enough; if no such hop exists, the table is
+ * doubled.
+ *
+ * @param p_table t_hopscotch* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return void* The value, or <code>NULL</code> if allocation failed
+ */
+void * ch_hopscotch_put(t_hopscotch * p_table, const char * p_key,
+    void * p_value) {
+
+  // Declarations
+  unsigned long int hash;
+  t_hop_slot * p_slot;
+  char * p_copy;
+
+  // Update value of extant pair
+  hash = ch_hash(p_key);
+
+  if ((p_slot = _find(p_table, p_key, hash)) != NULL) {
+    p_slot->p_value = p_value;
+    return p_value;
+  }
+
+  if ((p_copy = malloc(strlen(p_key) + 1)) == NULL) {
+    return NULL;
+  }
+
+  strcpy(p_copy, p_key);
+
+  while (!_insert(p_table->p_slots, p_table->size, p_copy, p_value, hash)) {
+    if (!_grow(p_table)) {
+      free(p_copy);
+      return NULL;
+    }
+  }
+
+  p_table->count++;
+  return p_value;
+}
+
+/**
+ * @brief The <code>ch_hopscotch_get</code> function retrieves the value mapped
+ * to <code>p_key</code> by visiting only those slots of the neighborhood that
+ * the home slot's bitmap marks as holding its keys.
+ *
+ * @param p_table t_hopscotch* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_hopscotch_get(t_hopscotch * p_table, const char * p_key) {
+
+  // Declaration
+  t_hop_slot * p_slot;
+
+  p_slot = _find(p_table, p_key, ch_hash(p_key));
+
+  return (p_slot != NULL) ? p_slot->p_value : NULL;
+}
+
+/**
+ * @brief The <code>ch_hopscotch_delete</code> function removes the pair mapped
+ * to <code>p_key</code> and returns its value. The slot is emptied and its bit
+ * cleared from the home slot's bitmap.
+ *
+ * @param p_table t_hopscotch* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_hopscotch_delete(t_hopscotch * p_table, const char * p_key) {
+
+  // Declarations
+  unsigned long int hash, home;
+  t_hop_slot * p_slot;
+  void * p_value_storage;
+
+  // Definitions
+  hash = ch_hash(p_key);
+  home = _home(hash, p_table->size);
+
+  if ((p_slot = _find(p_table, p_key, hash)) == NULL) {
+    return NULL;
+  }
+
+  // Clear this slot's bit, measuring its distance around the wrap if need be
+  p_table->p_slots[home].hop &= ~((uint32_t) 1 <<
+    ((p_slot - p_table->p_slots) + p_table->size - home) % p_table->size);
+
+  p_value_storage = p_slot->p_value;
+  free(p_slot->p_key);
+  p_slot->p_key = NULL;
+  p_table->count--;
+
+  return p_value_storage;
+}
+
+/**
+ * @brief The <code>ch_hopscotch_clear</code> function deallocates every key in
+ * the table and empties every slot.
+ *
+ * @param p_table t_hopscotch* A pointer to the specific hash table
+ * @return void
+ */
+void ch_hopscotch_clear(t_hopscotch * p_table) {
+
+  // Declaration
+  unsigned long int counter;
+
+  for (counter = 0; counter < p_table->size; counter++) {
+    free(p_table->p_slots[counter].p_key);
+  }
+
+  memset(p_table->p_slots, 0, sizeof(t_hop_slot) * p_table->size);
+  p_table->count = 0;
+}
+
+/**
+ * @brief The <code>ch_hopscotch_destroy</code> function clears the table, then
+ * deallocates its slots and the table itself.
+ *
+ * @param p_table t_hopscotch* A pointer to the specific hash table
+ * @return void
+ */
+void ch_hopscotch_destroy(t_hopscotch * p_table) {
+
+  if (p_table == NULL) {
+    return;
+  }
+
+  ch_hopscotch_clear(p_table);
+  free(p_table->p_slots);
+  free(p_table);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file chash_hopscotch.h
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Header file for CHash tables using hopscotch hashing
+ */
+
+#ifndef __CHASH_HOPSCOTCH_H_
+#define __CHASH_HOPSCOTCH_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Size of the neighborhood of each slot. A key is always stored within
+ * this many slots of its home slot, which bounds every lookup.
+ */
+#define CH_HOPSCOTCH_RANGE 32
+
+/**
+ * @brief The <code>t_hop_slot</code> <code>struct</code> is one slot of the
+ * flat array of a <code>t_hopscotch</code>. Besides the key/value pair it may
+ * hold, it carries the neighborhood bitmap of the slot in its role as a home
+ * slot: bit <code>i</code> of <code>hop</code> is set when the slot
+ * <code>i</code> positions further along holds a key whose home is this slot.
+ * A lookup therefore visits only the slots whose bits are set.
+ */
+typedef struct {
+  char * p_key;                 /**< Key, or <code>NULL</code> if empty */
+  void * p_value;               /**< Void pointer representing the value */
+  unsigned long int hash;       /**< Cached hash of the key string */
+  uint32_t hop;                 /**< Neighborhood bitmap of this home slot */
+} t_hop_slot;
+
+/**
+ * @brief The <code>t_hopscotch</code> <code>struct</code> is a hash table
+ * using open addressing over the flat array <code>p_slots</code>. Because each
+ * key is confined to the <code>CH_HOPSCOTCH_RANGE</code> slots following its
+ * home slot, the table can run at load factors above 90 percent without lookups
+ * degrading, and deletion simply empties a slot, with no tombstone.
+ */
+typedef struct {
+  unsigned long int size;       /**< Number of slots */
+  unsigned long int count;      /**< Number of key/value pairs stored */
+  t_hop_slot * p_slots;         /**< Flat array of slots */
+} t_hopscotch;
+
+/**
+ * @brief The <code>ch_hopscotch_create</code> function constructs an empty
+ * hopscotch table of <code>table_size</code> slots. The table grows whenever
+ * a key cannot be placed within its neighborhood, so the size given is only a
+ * starting point.
+ *
+ * @param table_size unsigned long int Initial number of slots
+ * @return t_hopscotch* A pointer to the specific hash table
+ */
+t_hopscotch * ch_hopscotch_create(unsigned long int table_size);
+
+/**
+ * @brief The <code>ch_hopscotch_put</code> function maps <code>p_key</code> to
+ * <code>p_value</code>, updating the value if the key is already present, as
+ * <code>ch_put</code> does. A new key takes the nearest free slot at or after
+ * its home. If that slot lies outside the neighborhood, keys between the two
+ * are hopped forward into it, each staying within its own neighborhood, until
+ * the free slot is brought close enough; if no such hop exists, the table is
+ * doubled.
+ *
+ * @param p_table t_hopscotch* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return void* The value, or <code>NULL</code> if allocation failed
+ */
+void * ch_hopscotch_put(t_hopscotch * p_table, const char * p_key,
+  void * p_value);
+
+/**
+ * @brief The <code>ch_hopscotch_get</code> function retrieves the value mapped
+ * to <code>p_key</code> by visiting only those slots of the neighborhood that
+ * the home slot's bitmap marks as holding its keys.
+ *
+ * @param p_table t_hopscotch* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_hopscotch_get(t_hopscotch * p_table, const char * p_key);
+
+/**
+ * @brief The <code>ch_hopscotch_delete</code> function removes the pair mapped
+ * to <code>p_key</code> and returns its value. The slot is emptied and its bit
+ * cleared from the home slot's bitmap.
+ *
+ * @param p_table t_hopscotch* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_hopscotch_delete(t_hopscotch * p_table, const char * p_key);
+
+/**
+ * @brief The <code>ch_hopscotch_clear</code> function deallocates every key in
+ * the table and empties every slot.
+ *
+ * @param p_table t_hopscotch* A pointer to the specific hash table
+ * @return void
+ */
+void ch_hopscotch_clear(t_hopscotch * p_table);
+
+/**
+ * @brief The <code>ch_hopscotch_destroy</code> function clears the table, then
+ * deallocates its slots and the table itself.
+ *
+ * @param p_table t_hopscotch* A pointer to the specific hash table
+ * @return void
+ */
+void ch_hopscotch_destroy(t_hopscotch * p_table);
+
+#endif
@@ -0,0 +1,294 @@
+/**
+ * @file chash_line.c
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Source file for CHash tables whose slots are whole cache lines
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "chash_line.h"
+
+/**
+ * @brief The <code>t_line_node</code> <code>struct</code> holds one key/value
+ * pair of a cache-line table. Lines rather than nodes are chained, and each
+ * line keeps its nodes' hash fragments, so unlike <code>t_property</code> a
+ * node needs neither a next pointer nor a hash, nor any expiry, budget or
+ * recency state; it is only the value with the key stored inline after it.
+ */
+typedef struct s_line_node {
+  void * p_value;               /**< Void pointer to the associated value */
+  char key[];                   /**< String representing the key, inline */
+} t_line_node;
+
+_Static_assert(sizeof(t_line) == 64, "t_line must fill one cache line");
+
+/**
+ * @brief The <code>_construct</code> helper function builds a node for
+ * <code>p_key</code> and <code>p_value</code>. Unlike its namesake in
+ * <code>chash.c</code>, the key is stored in the same allocation as the node,
+ * directly after its value, so that reading the key after a fragment match
+ * does not incur a further cache miss.
+ *
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return t_line_node* The new node, or <code>NULL</code>
+ */
+static t_line_node * _construct(const char * p_key, void * p_value) {
+
+  // Declarations
+  t_line_node * p_entry;
+  unsigned long int length;
+
+  // Definitions
+  length = strlen(p_key) + 1;
+
+  if ((p_entry = malloc(sizeof(t_line_node) + length)) == NULL) {
+    return NULL;
+  }
+
+  memcpy(p_entry->key, p_key, length);
+  p_entry->p_value = p_value;
+
+  return p_entry;
+}
+
+/**
+ * @brief The <code>ch_line_create</code> function is used to construct a new
+ * cache-line hash table with <code>table_size</code> slots. The slot array is
+ * allocated on a 64-byte boundary so that no slot straddles two lines.
+ *
+ * @param table_size unsigned long int Desired number of table slots
+ * @return t_line_table* A pointer to the specific hash table
+ */
+t_line_table * ch_line_create(unsigned long int table_size) {
+
+  // Declaration
+  t_line_table * p_table;
+
+  if ((p_table = malloc(sizeof(t_line_table))) == NULL) {
+    return NULL;
+  }
+
+  p_table->size = table_size;
+  p_table->p_lines = aligned_alloc(sizeof(t_line), sizeof(t_line) * table_size);
+
+  if (p_table->p_lines == NULL) {
+    free(p_table);
+    return NULL;
+  }
+
+  // Zeroed lines are empty, with no overflow
+  memset(p_table->p_lines, 0, sizeof(t_line) * table_size);
+
+  return p_table;
+}
+
+/**
+ * @brief The <code>ch_line_put</code> function maps <code>p_key</code> to
+ * <code>p_value</code> exactly as <code>ch_put</code> does. A new property is
+ * placed in the first line of the slot's chain with a free position, and an
+ * overflow line is added only if every line in the chain is full.
+ *
+ * @param p_table t_line_table* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return void* The value, or <code>NULL</code> if allocation failed
+ */
+void * ch_line_put(t_line_table * p_table, const char * p_key, void * p_value) {
+
+  // Declarations
+  unsigned long int hash;
+  uint32_t fragment, position;
+  t_line * p_line, * p_free, * p_last;
+  t_line_node * p_entry;
+
+  // Definitions
+  hash = ch_hash(p_key);
+  fragment = (uint32_t) hash;
+  p_free = NULL;
+  p_last = NULL;
+
+  // Update the extant property if found, noting the first line with room
+  for (p_line = &p_table->p_lines[hash % p_table->size]; p_line != NULL;
+      p_line = p_line->p_overflow) {
+    for (position = 0; position < p_line->count; position++) {
+      if (p_line->hashes[position] == fragment &&
+          strcmp(p_line->p_entries[position]->key, p_key) == 0) {
+        p_line->p_entries[position]->p_value = p_value;
+        return p_value;
+      }
+    }
+
+    if (p_free == NULL && p_line->count < CH_LINE_WIDTH) {
+      p_free = p_line;
+    }
+
+    p_last = p_line;
+  }
+
+  if ((p_entry = _construct(p_key, p_value)) == NULL) {
+    return NULL;
+  }
+
+  // Every line in the chain is full, so chain a fresh overflow line
+  if (p_free == NULL) {
+    if ((p_free = aligned_alloc(sizeof(t_line), sizeof(t_line))) == NULL) {
+      free(p_entry);
+      return NULL;
+    }
+
+    memset(p_free, 0, sizeof(t_line));
+    p_last->p_overflow = p_free;
+  }
+
+  p_free->hashes[p_free->count] = fragment;
+  p_free->p_entries[p_free->count++] = p_entry;
+
+  return p_value;
+}
+
+/**
+ * @brief The <code>ch_line_get</code> function retrieves the value mapped to
+ * <code>p_key</code>, as <code>ch_get</code> does. Unless the slot has
+ * overflowed, only one cache line is read before the key comparison.
+ *
+ * @param p_table t_line_table* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_line_get(t_line_table * p_table, const char * p_key) {
+
+  // Declarations
+  unsigned long int hash;
+  uint32_t fragment, position;
+  t_line * p_line;
+
+  // Definitions
+  hash = ch_hash(p_key);
+  fragment = (uint32_t) hash;
+
+  for (p_line = &p_table->p_lines[hash % p_table->size]; p_line != NULL;
+      p_line = p_line->p_overflow) {
+    for (position = 0; position < p_line->count; position++) {
+      if (p_line->hashes[position] == fragment &&
+          strcmp(p_line->p_entries[position]->key, p_key) == 0) {
+        return p_line->p_entries[position]->p_value;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief The <code>ch_line_delete</code> function removes the property mapped
+ * to <code>p_key</code> and returns its value, as <code>ch_delete</code> does.
+ * The last position of the line is moved into the vacated one so that the
+ * occupied positions of every line remain contiguous, and an entry is pulled
+ * back from any overflow line so that only full lines ever have overflow.
+ * Overflow lines that become empty are released.
+ *
+ * @param p_table t_line_table* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_line_delete(t_line_table * p_table, const char * p_key) {
+
+  // Declarations
+  unsigned long int hash;
+  uint32_t fragment, position;
+  t_line * p_line, * p_previous, * p_next;
+  void * p_value_storage;
+
+  // Definitions
+  hash = ch_hash(p_key);
+  fragment = (uint32_t) hash;
+  p_previous = NULL;
+
+  for (p_line = &p_table->p_lines[hash % p_table->size]; p_line != NULL;
+      p_previous = p_line, p_line = p_line->p_overflow) {
+    for (position = 0; position < p_line->count; position++) {
+      if (p_line->hashes[position] != fragment ||
+          strcmp(p_line->p_entries[position]->key, p_key) != 0) {
+        continue;
+      }
+
+      p_value_storage = p_line->p_entries[position]->p_value;
+      free(p_line->p_entries[position]);
+
+      // Fill the hole with the line's last occupied position
+      p_line->count--;
+      p_line->hashes[position] = p_line->hashes[p_line->count];
+      p_line->p_entries[position] = p_line->p_entries[p_line->count];
+
+      // Pull entries forward so that only full lines have overflow lines
+      for (; (p_next = p_line->p_overflow) != NULL; p_previous = p_line,
+          p_line = p_next) {
+        p_next->count--;
+        p_line->hashes[p_line->count] = p_next->hashes[p_next->count];
+        p_line->p_entries[p_line->count++] = p_next->p_entries[p_next->count];
+      }
+
+      // Release the last overflow line once it holds nothing
+      if (p_line->count == 0 && p_previous != NULL) {
+        p_previous->p_overflow = NULL;
+        free(p_line);
+      }
+
+      return p_value_storage;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief The <code>ch_line_clear</code> function deallocates every property
+ * and overflow line in the table, leaving all slots empty.
+ *
+ * @param p_table t_line_table* A pointer to the specific hash table
+ * @return void
+ */
+void ch_line_clear(t_line_table * p_table) {
+
+  // Declarations
+  unsigned long int counter;
+  uint32_t position;
+  t_line * p_line, * p_next;
+
+  for (counter = 0; counter < p_table->size; counter++) {
+    for (p_line = &p_table->p_lines[counter]; p_line != NULL; p_line = p_next) {
+      p_next = p_line->p_overflow;
+
+      for (position = 0; position < p_line->count; position++) {
+        free(p_line->p_entries[position]);
+      }
+
+      // The first line belongs to the slot array and is merely reset
+      if (p_line != &p_table->p_lines[counter]) {
+        free(p_line);
+      }
+    }
+
+    memset(&p_table->p_lines[counter], 0, sizeof(t_line));
+  }
+}
+
+/**
+ * @brief The <code>ch_line_destroy</code> function clears the table, then
+ * deallocates the slot array and the table itself.
+ *
+ * @param p_table t_line_table* A pointer to the specific hash table
+ * @return void
+ */
+void ch_line_destroy(t_line_table * p_table) {
+
+  if (p_table == NULL) {
+    return;
+  }
+
+  ch_line_clear(p_table);
+  free(p_table->p_lines);
+  free(p_table);
+}
@@ -0,0 +1,119 @@
+/**
+ * @file chash_line.h
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Header file for CHash tables whose slots are whole cache lines
+ */
+
+#ifndef __CHASH_LINE_H_
+#define __CHASH_LINE_H_
+
+#include <stdint.h>
+#include "chash.h"
+
+/**
+ * @brief Number of properties held inline by a single <code>t_line</code>
+ */
+#define CH_LINE_WIDTH 4
+
+/**
+ * @brief The <code>s_line_node</code> <code>struct</code> holds a single
+ * key/value pair of a <code>t_line_table</code>. Its layout is private to
+ * chash_line.c.
+ */
+struct s_line_node;
+
+/**
+ * @brief The <code>t_line</code> <code>struct</code> is one slot of a
+ * <code>t_line_table</code>, sized and aligned to occupy exactly one 64-byte
+ * cache line. In place of the single property pointer held by each slot of a
+ * <code>t_table</code>, it holds up to <code>CH_LINE_WIDTH</code> pairs of
+ * 32-bit hash fragments and node pointers. A lookup scans the fragments, all
+ * of which arrive with the line's first cache miss, and dereferences only
+ * those nodes whose fragments match. Should a line fill, further
+ * properties go into overflow lines chained from <code>p_overflow</code>.
+ */
+typedef struct s_line {
+  _Alignas(64) uint32_t hashes[CH_LINE_WIDTH]; /**< Low bits of each hash */
+  struct s_line_node * p_entries[CH_LINE_WIDTH]; /**< Nodes held by line */
+  struct s_line * p_overflow;   /**< Next line if this one has filled */
+  uint32_t count;               /**< Number of occupied positions */
+} t_line;
+
+/**
+ * @brief The <code>t_line_table</code> <code>struct</code> mirrors
+ * <code>t_table</code>, save that <code>p_lines</code> is a flat array of
+ * cache-line slots rather than an array of pointers to list heads.
+ */
+typedef struct {
+  unsigned long int size;       /**< Total number of cache-line slots */
+  t_line * p_lines;             /**< Array of cache-line slots */
+} t_line_table;
+
+/**
+ * @brief The <code>ch_line_create</code> function is used to construct a new
+ * cache-line hash table with <code>table_size</code> slots. The slot array is
+ * allocated on a 64-byte boundary so that no slot straddles two lines.
+ *
+ * @param table_size unsigned long int Desired number of table slots
+ * @return t_line_table* A pointer to the specific hash table
+ */
+t_line_table * ch_line_create(unsigned long int table_size);
+
+/**
+ * @brief The <code>ch_line_put</code> function maps <code>p_key</code> to
+ * <code>p_value</code> exactly as <code>ch_put</code> does. A new property is
+ * placed in the first line of the slot's chain with a free position, and an
+ * overflow line is added only if every line in the chain is full.
+ *
+ * @param p_table t_line_table* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return void* The value, or <code>NULL</code> if allocation failed
+ */
+void * ch_line_put(t_line_table * p_table, const char * p_key, void * p_value);
+
+/**
+ * @brief The <code>ch_line_get</code> function retrieves the value mapped to
+ * <code>p_key</code>, as <code>ch_get</code> does. Unless the slot has
+ * overflowed, only one cache line is read before the key comparison.
+ *
+ * @param p_table t_line_table* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_line_get(t_line_table * p_table, const char * p_key);
+
+/**
+ * @brief The <code>ch_line_delete</code> function removes the property mapped
+ * to <code>p_key</code> and returns its value, as <code>ch_delete</code> does.
+ * The last position of the line is moved into the vacated one so that the
+ * occupied positions of every line remain contiguous, and an entry is pulled
+ * back from any overflow line so that only full lines ever have overflow.
+ * Overflow lines that become empty are released.
+ *
+ * @param p_table t_line_table* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_line_delete(t_line_table * p_table, const char * p_key);
+
+/**
+ * @brief The <code>ch_line_clear</code> function deallocates every property
+ * and overflow line in the table, leaving all slots empty.
+ *
+ * @param p_table t_line_table* A pointer to the specific hash table
+ * @return void
+ */
+void ch_line_clear(t_line_table * p_table);
+
+/**
+ * @brief The <code>ch_line_destroy</code> function clears the table, then
+ * deallocates the slot array and the table itself.
+ *
+ * @param p_table t_line_table* A pointer to the specific hash table
+ * @return void
+ */
+void ch_line_destroy(t_line_table * p_table);
+
+#endif
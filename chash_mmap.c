@@ -0,0 +1,282 @@
+/**
+ * @file chash_mmap.c
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Source file for the frozen, memory-mapped, read-only CHash layout
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "chash_mmap.h"
+
+/**
+ * @brief Magic string written at the start of every frozen table file
+ */
+static const char MAGIC[8] = {'C', 'H', 'A', 'S', 'H', 'M', 'M', '1'};
+
+/**
+ * @brief The <code>_align</code> helper function rounds the byte count passed
+ * as <code>length</code> up to the next multiple of eight so that every record
+ * and every value in the file begins on an eight-byte boundary.
+ *
+ * @param length uint64_t The unaligned byte count
+ * @return uint64_t The byte count rounded up to a multiple of eight
+ */
+static uint64_t _align(uint64_t length) {
+  return (length + 7) & ~((uint64_t) 7);
+}
+
+/**
+ * @brief The <code>_record_length</code> helper function returns the number of
+ * bytes occupied in the file by a single record. Each record is laid out as a
+ * 64-bit hash, a 32-bit key length, a 32-bit value length, the NUL-terminated
+ * key padded to eight bytes, and finally the value bytes, likewise padded.
+ *
+ * @param key_length uint64_t Length of the key, excluding the terminator
+ * @param value_length uint64_t Length of the value in bytes
+ * @return uint64_t Total length of the record in bytes
+ */
+static uint64_t _record_length(uint64_t key_length, uint64_t value_length) {
+  return 16 + _align(key_length + 1) + _align(value_length);
+}
+
+/**
+ * @brief The <code>ch_mmap_write</code> function serializes the hash table
+ * denoted by <code>p_table</code> into the frozen on-disk layout at the path
+ * <code>p_path</code>. Since the table itself stores only void pointers, the
+ * caller supplies <code>p_size</code>, a function returning the number of bytes
+ * at each value's address; those bytes are copied into the file verbatim. If
+ * <code>p_size</code> is <code>NULL</code>, no value bytes are written and the
+ * file acts as a set of keys. Records are grouped by slot and refer to one
+ * another only by offset, so the file is valid at any address it is mapped.
+ * As each record stores its key and value lengths in 32 bits, a table holding
+ * any key or value of 4 GiB or more is rejected before the file is created.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_path const char* Path of the file to be created or truncated
+ * @param p_size unsigned long int (*)(const void*) Value size callback
+ * @return int 0 on success, -1 if the file could not be written
+ */
+int ch_mmap_write(t_table * p_table, const char * p_path,
+    unsigned long int (* p_size)(const void * p_value)) {
+
+  // Declarations
+  FILE * p_file;
+  t_mmap_header header;
+  t_property * p_entry;
+  uint64_t * p_slots, offset, hash, key_length, value_length;
+  uint32_t lengths[2];
+  unsigned long int counter;
+  static const unsigned char padding[8] = {0};
+
+  // Definitions
+  p_slots = malloc(sizeof(uint64_t) * (p_table->size + 1));
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.size = p_table->size;
+  header.count = 0;
+  offset = sizeof(t_mmap_header) + sizeof(uint64_t) * (p_table->size + 1);
+
+  if (p_slots == NULL) {
+    return -1;
+  }
+
+  // First pass computes the offset at which each slot's records will begin
+  for (counter = 0; counter < p_table->size; counter++) {
+    p_slots[counter] = offset;
+
+    for (p_entry = p_table->p_entries[counter]; p_entry != NULL;
+        p_entry = p_entry->p_next) {
+      key_length = strlen(p_entry->p_key);
+      value_length = (p_size != NULL) ? p_size(p_entry->p_value) : 0;
+
+      // Lengths are stored in 32 bits, so larger entries cannot be written
+      if (key_length >= UINT32_MAX || value_length > UINT32_MAX) {
+        free(p_slots);
+        return -1;
+      }
+
+      offset += _record_length(key_length, value_length);
+      header.count++;
+    }
+  }
+
+  p_slots[p_table->size] = offset;
+  header.length = offset;
+
+  if ((p_file = fopen(p_path, "wb")) == NULL) {
+    free(p_slots);
+    return -1;
+  }
+
+  fwrite(&header, sizeof(t_mmap_header), 1, p_file);
+  fwrite(p_slots, sizeof(uint64_t), p_table->size + 1, p_file);
+  free(p_slots);
+
+  // Second pass emits the records themselves in the same order
+  for (counter = 0; counter < p_table->size; counter++) {
+    for (p_entry = p_table->p_entries[counter]; p_entry != NULL;
+        p_entry = p_entry->p_next) {
+      hash = p_entry->hash;
+      lengths[0] = strlen(p_entry->p_key);
+      lengths[1] = (p_size != NULL) ? p_size(p_entry->p_value) : 0;
+
+      fwrite(&hash, sizeof(uint64_t), 1, p_file);
+      fwrite(lengths, sizeof(uint32_t), 2, p_file);
+      fwrite(p_entry->p_key, 1, lengths[0] + 1, p_file);
+      fwrite(padding, 1, _align(lengths[0] + 1) - (lengths[0] + 1), p_file);
+      fwrite(p_entry->p_value, 1, lengths[1], p_file);
+      fwrite(padding, 1, _align(lengths[1]) - lengths[1], p_file);
+    }
+  }
+
+  // Surface any write error buffered by the stream
+  if (ferror(p_file)) {
+    fclose(p_file);
+    return -1;
+  }
+
+  return (fclose(p_file) == 0) ? 0 : -1;
+}
+
+/**
+ * @brief The <code>ch_mmap_open</code> function maps a file produced by
+ * <code>ch_mmap_write</code> into memory read-only and validates its header.
+ * No records are read or copied, so the cost of opening is independent of the
+ * size of the table; pages are faulted in lazily by lookups and are shared in
+ * the page cache by every process mapping the same file.
+ *
+ * @param p_path const char* Path of the frozen table file
+ * @return t_mmap* A handle to the mapped table, or <code>NULL</code> on failure
+ */
+t_mmap * ch_mmap_open(const char * p_path) {
+
+  // Declarations
+  t_mmap * p_map;
+  struct stat status;
+  void * p_base;
+  int descriptor;
+
+  if ((descriptor = open(p_path, O_RDONLY)) < 0) {
+    return NULL;
+  }
+
+  // Reject anything too short to hold the header before mapping it
+  if (fstat(descriptor, &status) != 0 ||
+      (unsigned long int) status.st_size < sizeof(t_mmap_header)) {
+    close(descriptor);
+    return NULL;
+  }
+
+  p_base = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+
+  // The mapping holds its own reference to the file
+  close(descriptor);
+
+  if (p_base == MAP_FAILED) {
+    return NULL;
+  }
+
+  // Validate magic, declared length and slot array bounds
+  if (memcmp(((t_mmap_header *) p_base)->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      ((t_mmap_header *) p_base)->length != (uint64_t) status.st_size ||
+      ((t_mmap_header *) p_base)->size == 0 ||
+      ((t_mmap_header *) p_base)->size >
+        (status.st_size - sizeof(t_mmap_header)) / sizeof(uint64_t) - 1) {
+    munmap(p_base, status.st_size);
+    return NULL;
+  }
+
+  if ((p_map = malloc(sizeof(t_mmap))) == NULL) {
+    munmap(p_base, status.st_size);
+    return NULL;
+  }
+
+  p_map->p_base = p_base;
+  p_map->length = status.st_size;
+  p_map->p_header = p_base;
+  p_map->p_slots = (const uint64_t *) (p_map->p_header + 1);
+
+  return p_map;
+}
+
+/**
+ * @brief The <code>ch_mmap_get</code> function is the frozen analogue of
+ * <code>ch_get</code>. It hashes <code>p_key</code> with the same function as
+ * <code>t_table</code>, walks the records stored for that slot, and returns a
+ * pointer to the matching record's value bytes inside the mapping. The pointer
+ * remains valid until <code>ch_mmap_close</code> is called and must not be
+ * written through. As the file may be corrupt, every slot offset, record
+ * offset and length read from it is checked against the mapping before use,
+ * and a lookup that meets one out of bounds returns <code>NULL</code>.
+ *
+ * @param p_map t_mmap* A pointer to the specific mapped table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A pointer to the value bytes, or <code>NULL</code> if absent
+ */
+void * ch_mmap_get(t_mmap * p_map, const char * p_key) {
+
+  // Declarations
+  uint64_t hash, offset, end, key_length, length;
+  const uint32_t * p_lengths;
+  const unsigned char * p_record;
+
+  // Definitions
+  hash = ch_hash(p_key);
+  key_length = strlen(p_key);
+  offset = p_map->p_slots[hash % p_map->p_header->size];
+  end = p_map->p_slots[hash % p_map->p_header->size + 1];
+
+  // Records must lie between the slot array and the end of the mapping
+  if (offset < sizeof(t_mmap_header) +
+      sizeof(uint64_t) * (p_map->p_header->size + 1) ||
+      end > p_map->length || offset > end) {
+    return NULL;
+  }
+
+  // Walk the records of this slot, comparing full hashes before keys
+  while (offset < end) {
+    if (offset % 8 != 0 || end - offset < 16) {
+      return NULL;
+    }
+
+    p_record = p_map->p_base + offset;
+    p_lengths = (const uint32_t *) (p_record + 8);
+    length = _record_length(p_lengths[0], p_lengths[1]);
+
+    if (length > end - offset || p_record[16 + p_lengths[0]] != '\0') {
+      return NULL;
+    }
+
+    if (*(const uint64_t *) p_record == hash && p_lengths[0] == key_length &&
+        memcmp(p_record + 16, p_key, key_length) == 0) {
+      return (void *) (p_record + 16 + _align(key_length + 1));
+    }
+
+    offset += length;
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief The <code>ch_mmap_close</code> function unmaps the file mapped by
+ * <code>ch_mmap_open</code> and deallocates the handle itself. Any pointers
+ * previously returned by <code>ch_mmap_get</code> are invalidated.
+ *
+ * @param p_map t_mmap* A pointer to the specific mapped table
+ * @return void
+ */
+void ch_mmap_close(t_mmap * p_map) {
+
+  if (p_map == NULL) {
+    return;
+  }
+
+  munmap(p_map->p_base, p_map->length);
+  free(p_map);
+}
@@ -0,0 +1,103 @@
+/**
+ * @file chash_mmap.h
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Header file for the frozen, memory-mapped, read-only CHash layout
+ */
+
+#ifndef __CHASH_MMAP_H_
+#define __CHASH_MMAP_H_
+
+#include <stdint.h>
+#include "chash.h"
+
+/**
+ * @brief The <code>t_mmap_header</code> <code>struct</code> sits at offset zero
+ * of every frozen table file. It carries a magic string used to reject foreign
+ * files, the number of hash slots the source <code>t_table</code> had, the
+ * number of key/value pairs written, and the total length of the file in bytes.
+ * Directly following the header is an array of <code>size + 1</code> offsets,
+ * where slot <code>i</code> owns the records lying between offsets
+ * <code>i</code> and <code>i + 1</code>. All fields use fixed-width types so
+ * the layout does not depend on the compiler, though it does assume readers
+ * and writers share the same byte order.
+ */
+typedef struct {
+  char magic[8];                /**< Always "CHASHMM1" for this layout */
+  uint64_t size;                /**< Number of hash slots in the file */
+  uint64_t count;               /**< Number of key/value records in the file */
+  uint64_t length;              /**< Total length of the file in bytes */
+} t_mmap_header;
+
+/**
+ * @brief The <code>t_mmap</code> <code>struct</code> is the handle returned by
+ * <code>ch_mmap_open</code>. It holds the base address of the read-only mapping
+ * and its length, along with typed pointers into the header and the slot
+ * offset array so that lookups need not recompute them on each call.
+ */
+typedef struct {
+  unsigned char * p_base;       /**< Base address of the mapping */
+  unsigned long int length;     /**< Length of the mapping in bytes */
+  const t_mmap_header * p_header; /**< Header at the start of the mapping */
+  const uint64_t * p_slots;     /**< Per-slot record offsets */
+} t_mmap;
+
+/**
+ * @brief The <code>ch_mmap_write</code> function serializes the hash table
+ * denoted by <code>p_table</code> into the frozen on-disk layout at the path
+ * <code>p_path</code>. Since the table itself stores only void pointers, the
+ * caller supplies <code>p_size</code>, a function returning the number of bytes
+ * at each value's address; those bytes are copied into the file verbatim. If
+ * <code>p_size</code> is <code>NULL</code>, no value bytes are written and the
+ * file acts as a set of keys. Records are grouped by slot and refer to one
+ * another only by offset, so the file is valid at any address it is mapped.
+ * As each record stores its key and value lengths in 32 bits, a table holding
+ * any key or value of 4 GiB or more is rejected before the file is created.
+ *
+ * @param p_table t_table* A pointer to the specific hash table
+ * @param p_path const char* Path of the file to be created or truncated
+ * @param p_size unsigned long int (*)(const void*) Value size callback
+ * @return int 0 on success, -1 if the file could not be written
+ */
+int ch_mmap_write(t_table * p_table, const char * p_path,
+  unsigned long int (* p_size)(const void * p_value));
+
+/**
+ * @brief The <code>ch_mmap_open</code> function maps a file produced by
+ * <code>ch_mmap_write</code> into memory read-only and validates its header.
+ * No records are read or copied, so the cost of opening is independent of the
+ * size of the table; pages are faulted in lazily by lookups and are shared in
+ * the page cache by every process mapping the same file.
+ *
+ * @param p_path const char* Path of the frozen table file
+ * @return t_mmap* A handle to the mapped table, or <code>NULL</code> on failure
+ */
+t_mmap * ch_mmap_open(const char * p_path);
+
+/**
+ * @brief The <code>ch_mmap_get</code> function is the frozen analogue of
+ * <code>ch_get</code>. It hashes <code>p_key</code> with the same function as
+ * <code>t_table</code>, walks the records stored for that slot, and returns a
+ * pointer to the matching record's value bytes inside the mapping. The pointer
+ * remains valid until <code>ch_mmap_close</code> is called and must not be
+ * written through. As the file may be corrupt, every slot offset, record
+ * offset and length read from it is checked against the mapping before use,
+ * and a lookup that meets one out of bounds returns <code>NULL</code>.
+ *
+ * @param p_map t_mmap* A pointer to the specific mapped table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A pointer to the value bytes, or <code>NULL</code> if absent
+ */
+void * ch_mmap_get(t_mmap * p_map, const char * p_key);
+
+/**
+ * @brief The <code>ch_mmap_close</code> function unmaps the file mapped by
+ * <code>ch_mmap_open</code> and deallocates the handle itself. Any pointers
+ * previously returned by <code>ch_mmap_get</code> are invalidated.
+ *
+ * @param p_map t_mmap* A pointer to the specific mapped table
+ * @return void
+ */
+void ch_mmap_close(t_mmap * p_map);
+
+#endif
@@ -0,0 +1,526 @@
+/**
+ * @file chash_numa.c
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Source file for NUMA-aware CHash placement and per-node replicas
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "chash_numa.h"
+
+/**
+ * @brief Length of each chunk mapped to hold small blocks, and the alignment
+ * of every region, chosen to match the size of a huge page
+ */
+#define CH_NUMA_CHUNK (1UL << 21)
+
+/**
+ * @brief Length of the header preceding every block, which records its size
+ * class and requested size. It also keeps blocks sixteen-byte aligned.
+ */
+#define CH_NUMA_HEADER 16
+
+/**
+ * @brief Memory policy modes of the Linux <code>mbind</code> system call, as
+ * defined in <code>numaif.h</code>, which is not always installed
+ */
+#define CH_MPOL_PREFERRED 1
+#define CH_MPOL_INTERLEAVE 3
+
+/**
+ * @brief The <code>_bind</code> helper function applies the heap's memory
+ * policy to the freshly mapped region at <code>p_region</code>. A heap for a
+ * single node merely prefers that node, so that allocation still succeeds when
+ * it is full; an interleaved heap spreads the region's pages across every
+ * node. Failure is ignored, leaving the kernel's default placement.
+ *
+ * @param p_heap t_numa_heap* The heap that mapped the region
+ * @param p_region void* Start of the region
+ * @param length unsigned long int Length of the region in bytes
+ * @return void
+ */
+static void _bind(t_numa_heap * p_heap, void * p_region,
+    unsigned long int length) {
+#ifdef SYS_mbind
+
+  // Declarations
+  unsigned long int mask;
+  int mode;
+
+  if (p_heap->node == CH_NUMA_INTERLEAVE) {
+    mode = CH_MPOL_INTERLEAVE;
+    mask = (p_heap->nodes >= sizeof(mask) * CHAR_BIT) ? ~0UL
+      : (1UL << p_heap->nodes) - 1;
+  } else {
+    mode = CH_MPOL_PREFERRED;
+    mask = 1UL << p_heap->node;
+  }
+
+  // The kernel reads one bit fewer than the count it is given
+  syscall(SYS_mbind, p_region, length, mode, &mask, sizeof(mask) * CHAR_BIT + 1,
+    0);
+#else
+  (void) p_heap;
+  (void) p_region;
+  (void) length;
+#endif
+}
+
+/**
+ * @brief The <code>_map</code> helper function maps a region of at least
+ * <code>length</code> bytes, rounded up to a whole chunk, binds it according
+ * to the heap's policy before any page is touched, and links it into the
+ * heap's list of regions. The region is aligned to a chunk, which is the size
+ * of a huge page, and the kernel is advised to back it with transparent huge
+ * pages, so that lookups chasing properties across a large table do not miss
+ * the TLB as often.
+ *
+ * @param p_heap t_numa_heap* A pointer to the heap
+ * @param length unsigned long int Length of the region in bytes
+ * @return t_numa_chunk* The region, or <code>NULL</code> if mapping failed
+ */
+static t_numa_chunk * _map(t_numa_heap * p_heap, unsigned long int length) {
+
+  // Declarations
+  unsigned char * p_region;
+  t_numa_chunk * p_chunk;
+  unsigned long int slack;
+
+  // Round to a whole chunk, so that the tail trimmed below is page-aligned
+  length = (length + CH_NUMA_CHUNK - 1) & ~(CH_NUMA_CHUNK - 1);
+
+  // Map a chunk extra, then trim both ends to leave an aligned region
+  p_region = mmap(NULL, length + CH_NUMA_CHUNK, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if (p_region == MAP_FAILED) {
+    return NULL;
+  }
+
+  slack = (CH_NUMA_CHUNK - (unsigned long int) p_region % CH_NUMA_CHUNK) %
+    CH_NUMA_CHUNK;
+
+  if (slack != 0) {
+    munmap(p_region, slack);
+  }
+
+  munmap(p_region + slack + length, CH_NUMA_CHUNK - slack);
+  p_chunk = (t_numa_chunk *) (p_region + slack);
+  _bind(p_heap, p_chunk, length);
+
+#ifdef MADV_HUGEPAGE
+  if (madvise(p_chunk, length, MADV_HUGEPAGE) == 0) {
+    p_heap->huge_pages = 1;
+  }
+#endif
+
+  p_chunk->p_next = p_heap->p_chunks;
+  p_chunk->length = length;
+  p_heap->p_chunks = p_chunk;
+
+  return p_chunk;
+}
+
+/**
+ * @brief The <code>_malloc</code> helper function allocates
+ * <code>size</code> bytes from the heap passed as <code>p_context</code>. The
+ * block is taken from its size class's free list, or else carved from the
+ * current chunk; a request too large for any class is given a region of its
+ * own.
+ *
+ * @param size unsigned long int Number of bytes to allocate
+ * @param p_context void* The heap
+ * @return void* The block, or <code>NULL</code>
+ */
+static void * _malloc(unsigned long int size, void * p_context) {
+
+  // Declarations
+  t_numa_heap * p_heap;
+  t_numa_chunk * p_chunk;
+  unsigned long int * p_header;
+  int size_class;
+
+  // Definitions
+  p_heap = p_context;
+
+  for (size_class = 0; size_class < CH_NUMA_CLASSES; size_class++) {
+    if ((16UL << size_class) >= size + CH_NUMA_HEADER) {
+      break;
+    }
+  }
+
+  if (size_class == CH_NUMA_CLASSES) {
+    if ((p_chunk = _map(p_heap, sizeof(t_numa_chunk) + CH_NUMA_HEADER + size))
+        == NULL) {
+      return NULL;
+    }
+
+    p_header = (unsigned long int *) (p_chunk + 1);
+  } else if ((p_header = p_heap->p_free[size_class]) != NULL) {
+    p_heap->p_free[size_class] = *(void **) (p_header + 2);
+  } else {
+
+    // Start a new chunk if the current one cannot hold the block
+    if ((unsigned long int) (p_heap->p_limit - p_heap->p_cursor) <
+        (16UL << size_class)) {
+      if ((p_chunk = _map(p_heap, CH_NUMA_CHUNK)) == NULL) {
+        return NULL;
+      }
+
+      p_heap->p_cursor = (unsigned char *) (p_chunk + 1);
+      p_heap->p_limit = (unsigned char *) p_chunk + CH_NUMA_CHUNK;
+    }
+
+    p_header = (unsigned long int *) p_heap->p_cursor;
+    p_heap->p_cursor += 16UL << size_class;
+  }
+
+  p_header[0] = size_class;
+  p_header[1] = size;
+
+  return p_header + 2;
+}
+
+/**
+ * @brief The <code>_free</code> helper function returns a block to the free
+ * list of its size class, or unmaps it if it occupies a region of its own.
+ *
+ * @param p_block void* The block to be released
+ * @param p_context void* The heap
+ * @return void
+ */
+static void _free(void * p_block, void * p_context) {
+
+  // Declarations
+  t_numa_heap * p_heap;
+  t_numa_chunk ** p_link, * p_chunk;
+  unsigned long int * p_header;
+
+  // Definitions
+  p_heap = p_context;
+  p_header = (unsigned long int *) p_block - 2;
+
+  if (p_header[0] < CH_NUMA_CLASSES) {
+    *(void **) p_block = p_heap->p_free[p_header[0]];
+    p_heap->p_free[p_header[0]] = p_header;
+    return;
+  }
+
+  // Unlink the block's own region before unmapping it
+  p_chunk = (t_numa_chunk *) p_header - 1;
+
+  for (p_link = &p_heap->p_chunks; *p_link != p_chunk;
+      p_link = &(*p_link)->p_next);
+
+  *p_link = p_chunk->p_next;
+  munmap(p_chunk, p_chunk->length);
+}
+
+/**
+ * @brief The <code>_realloc</code> helper function moves a block into one of
+ * <code>size</code> bytes allocated from the same heap.
+ *
+ * @param p_block void* The block to be resized, or <code>NULL</code>
+ * @param size unsigned long int New size of the block in bytes
+ * @param p_context void* The heap
+ * @return void* The resized block, or <code>NULL</code>
+ */
+static void * _realloc(void * p_block, unsigned long int size,
+    void * p_context) {
+
+  // Declarations
+  void * p_resized;
+  unsigned long int previous;
+
+  if ((p_resized = _malloc(size, p_context)) == NULL || p_block == NULL) {
+    return p_resized;
+  }
+
+  previous = ((unsigned long int *) p_block)[-1];
+  memcpy(p_resized, p_block, (previous < size) ? previous : size);
+  _free(p_block, p_context);
+
+  return p_resized;
+}
+
+/**
+ * @brief The <code>_node</code> helper function asks the kernel for the node
+ * of the CPU on which the calling thread is running.
+ *
+ * @param p_context void* Unused
+ * @return int The node, or 0 if it cannot be determined
+ */
+static int _node(void * p_context) {
+
+  // Declarations
+  unsigned int cpu, node;
+
+  (void) p_context;
+  node = 0;
+
+#ifdef SYS_getcpu
+  if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) {
+    node = 0;
+  }
+#else
+  (void) cpu;
+#endif
+
+  return node;
+}
+
+/**
+ * @brief The <code>ch_numa_heap_create</code> function constructs an empty
+ * heap whose memory will be bound to <code>node</code>, or interleaved across
+ * all <code>nodes</code> nodes if <code>node</code> is
+ * <code>CH_NUMA_INTERLEAVE</code>. Binding is advisory: if the kernel refuses
+ * it, as it will for nodes that do not exist, the memory is used regardless,
+ * so simulated topologies work on single-node machines.
+ *
+ * @param node int The node to bind to, or <code>CH_NUMA_INTERLEAVE</code>
+ * @param nodes unsigned long int Number of nodes in the topology, at most 64
+ * @return t_numa_heap* A pointer to the heap, or <code>NULL</code>
+ */
+t_numa_heap * ch_numa_heap_create(int node, unsigned long int nodes) {
+
+  // Declaration
+  t_numa_heap * p_heap;
+
+  if (nodes == 0 || nodes > sizeof(unsigned long int) * CHAR_BIT ||
+      node < CH_NUMA_INTERLEAVE || (node >= 0 &&
+        (unsigned long int) node >= nodes)) {
+    return NULL;
+  }
+
+  if ((p_heap = calloc(1, sizeof(t_numa_heap))) == NULL) {
+    return NULL;
+  }
+
+  p_heap->node = node;
+  p_heap->nodes = nodes;
+
+  return p_heap;
+}
+
+/**
+ * @brief The <code>ch_numa_heap_allocator</code> function returns a
+ * <code>t_allocator</code> drawing on <code>p_heap</code>, to be passed to
+ * <code>ch_create_ex</code>. Passing an interleaved heap spreads a single
+ * table's slot array and properties evenly over every node, so that no node's
+ * threads pay remote latency on every lookup.
+ *
+ * @param p_heap t_numa_heap* A pointer to the heap
+ * @return t_allocator The allocator
+ */
+t_allocator ch_numa_heap_allocator(t_numa_heap * p_heap) {
+
+  // Declaration
+  t_allocator allocator;
+
+  // Definitions
+  allocator.p_malloc = _malloc;
+  allocator.p_realloc = _realloc;
+  allocator.p_free = _free;
+  allocator.p_context = p_heap;
+
+  return allocator;
+}
+
+/**
+ * @brief The <code>ch_numa_heap_destroy</code> function unmaps every region of
+ * <code>p_heap</code>, and with them every block allocated from it, before
+ * deallocating the heap itself.
+ *
+ * @param p_heap t_numa_heap* A pointer to the heap
+ * @return void
+ */
+void ch_numa_heap_destroy(t_numa_heap * p_heap) {
+
+  // Declaration
+  t_numa_chunk * p_chunk;
+
+  if (p_heap == NULL) {
+    return;
+  }
+
+  while ((p_chunk = p_heap->p_chunks) != NULL) {
+    p_heap->p_chunks = p_chunk->p_next;
+    munmap(p_chunk, p_chunk->length);
+  }
+
+  free(p_heap);
+}
+
+/**
+ * @brief The <code>ch_numa_create</code> function constructs a table with one
+ * replica of <code>table_size</code> slots on each of <code>nodes</code>
+ * nodes. The function <code>p_node</code>, called with
+ * <code>p_context</code>, returns the node of the calling thread, and so
+ * selects the replica each lookup reads; if it is <code>NULL</code>, the node
+ * is asked of the kernel. Supplying it allows a topology to be simulated.
+ *
+ * @param table_size unsigned long int Number of slots in each replica
+ * @param nodes unsigned long int Number of nodes, at most 64
+ * @param p_node int (*)(void*) Returns the caller's node, or <code>NULL</code>
+ * @param p_context void* State passed to <code>p_node</code>
+ * @return t_numa* A pointer to the replicated table, or <code>NULL</code>
+ */
+t_numa * ch_numa_create(unsigned long int table_size, unsigned long int nodes,
+    int (* p_node)(void * p_context), void * p_context) {
+
+  // Declarations
+  t_numa * p_numa;
+  t_options options;
+  t_allocator allocator;
+  unsigned long int node;
+
+  if ((p_numa = calloc(1, sizeof(t_numa))) == NULL) {
+    return NULL;
+  }
+
+  p_numa->nodes = nodes;
+  p_numa->p_node = (p_node != NULL) ? p_node : _node;
+  p_numa->p_context = p_context;
+  p_numa->p_replicas = calloc(nodes, sizeof(t_table *));
+  p_numa->p_heaps = calloc(nodes, sizeof(t_numa_heap *));
+
+  if (p_numa->p_replicas == NULL || p_numa->p_heaps == NULL) {
+    ch_numa_destroy(p_numa);
+    return NULL;
+  }
+
+  // Build each replica, table and all, from its own node's heap
+  memset(&options, 0, sizeof(options));
+  options.p_allocator = &allocator;
+
+  for (node = 0; node < nodes; node++) {
+    if ((p_numa->p_heaps[node] = ch_numa_heap_create(node, nodes)) == NULL) {
+      ch_numa_destroy(p_numa);
+      return NULL;
+    }
+
+    allocator = ch_numa_heap_allocator(p_numa->p_heaps[node]);
+
+    if ((p_numa->p_replicas[node] = ch_create_ex(table_size, &options)) ==
+        NULL) {
+      ch_numa_destroy(p_numa);
+      return NULL;
+    }
+  }
+
+  return p_numa;
+}
+
+/**
+ * @brief The <code>ch_numa_put</code> function maps <code>p_key</code> to
+ * <code>p_value</code> in every replica, hashing the key only once. Should any
+ * replica fail to allocate, the key is removed from all of them, so that the
+ * replicas never disagree, and <code>NULL</code> is returned. As with
+ * <code>t_table</code>, writes must not run concurrently with other calls.
+ *
+ * @param p_numa t_numa* A pointer to the replicated table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return void* The value, or <code>NULL</code> if allocation failed
+ */
+void * ch_numa_put(t_numa * p_numa, const char * p_key, void * p_value) {
+
+  // Declarations
+  t_key handle;
+  unsigned long int node;
+
+  // Definition
+  handle = ch_key(p_key);
+
+  for (node = 0; node < p_numa->nodes; node++) {
+    if (ch_put_h(p_numa->p_replicas[node], &handle, p_value) == NULL &&
+        p_value != NULL) {
+      break;
+    }
+  }
+
+  if (node == p_numa->nodes) {
+    return p_value;
+  }
+
+  for (node = 0; node < p_numa->nodes; node++) {
+    ch_delete_h(p_numa->p_replicas[node], &handle);
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief The <code>ch_numa_get</code> function retrieves the value mapped to
+ * <code>p_key</code> from the replica of the calling thread's node. Lookups
+ * modify nothing and may run concurrently with one another.
+ *
+ * @param p_numa t_numa* A pointer to the replicated table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_numa_get(t_numa * p_numa, const char * p_key) {
+  return ch_get(p_numa->p_replicas[(unsigned int)
+    p_numa->p_node(p_numa->p_context) % p_numa->nodes], p_key);
+}
+
+/**
+ * @brief The <code>ch_numa_delete</code> function removes <code>p_key</code>
+ * from every replica and returns the value it was mapped to.
+ *
+ * @param p_numa t_numa* A pointer to the replicated table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_numa_delete(t_numa * p_numa, const char * p_key) {
+
+  // Declarations
+  t_key handle;
+  unsigned long int node;
+  void * p_value_storage;
+
+  // Definitions
+  handle = ch_key(p_key);
+  p_value_storage = NULL;
+
+  for (node = 0; node < p_numa->nodes; node++) {
+    p_value_storage = ch_delete_h(p_numa->p_replicas[node], &handle);
+  }
+
+  return p_value_storage;
+}
+
+/**
+ * @brief The <code>ch_numa_destroy</code> function destroys every replica and
+ * the heap backing it, then deallocates the replicated table itself.
+ *
+ * @param p_numa t_numa* A pointer to the replicated table
+ * @return void
+ */
+void ch_numa_destroy(t_numa * p_numa) {
+
+  // Declaration
+  unsigned long int node;
+
+  if (p_numa == NULL) {
+    return;
+  }
+
+  // A heap is unmapped wholesale, so its replica need not free each property
+  for (node = 0; node < p_numa->nodes; node++) {
+    if (p_numa->p_heaps != NULL) {
+      ch_numa_heap_destroy(p_numa->p_heaps[node]);
+    }
+  }
+
+  free(p_numa->p_replicas);
+  free(p_numa->p_heaps);
+  free(p_numa);
+}
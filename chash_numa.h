@@ -0,0 +1,167 @@
+/**
+ * @file chash_numa.h
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Header file for NUMA-aware CHash placement and per-node replicas
+ */
+
+#ifndef __CHASH_NUMA_H_
+#define __CHASH_NUMA_H_
+
+#include "chash.h"
+
+/**
+ * @brief Node number given to <code>ch_numa_heap_create</code> to spread a
+ * heap's pages round-robin across every node rather than binding them to one
+ */
+#define CH_NUMA_INTERLEAVE (-1)
+
+/**
+ * @brief Number of block size classes in a heap. Class <code>c</code> holds
+ * blocks of <code>16 << c</code> bytes; larger requests are mapped singly.
+ */
+#define CH_NUMA_CLASSES 16
+
+/**
+ * @brief The <code>s_numa_chunk</code> <code>struct</code> heads each region
+ * mapped by a heap, so that the heap can unmap them all when destroyed.
+ */
+typedef struct s_numa_chunk {
+  struct s_numa_chunk * p_next; /**< Region mapped before this one */
+  unsigned long int length;     /**< Length of the region in bytes */
+} t_numa_chunk;
+
+/**
+ * @brief The <code>t_numa_heap</code> <code>struct</code> is an allocator
+ * whose memory is mapped directly from the kernel and bound to a single NUMA
+ * node, or interleaved across all nodes, before it is first touched. Small
+ * blocks are carved from shared chunks and recycled through per-class free
+ * lists; large blocks, such as a table's slot array, are mapped and bound
+ * individually, each rounded up to a whole chunk. Every region is advised onto
+ * transparent huge pages, and <code>huge_pages</code> records whether the
+ * kernel accepted the advice, which it does even where it has none to give.
+ */
+typedef struct {
+  int node;                     /**< Node bound to, or CH_NUMA_INTERLEAVE */
+  unsigned long int nodes;      /**< Number of nodes in the topology */
+  t_numa_chunk * p_chunks;      /**< Most recently mapped chunk */
+  unsigned char * p_cursor;     /**< Next unused byte of the current chunk */
+  unsigned char * p_limit;      /**< End of the current chunk */
+  void * p_free[CH_NUMA_CLASSES]; /**< Free list head of each size class */
+  int huge_pages;               /**< Nonzero once huge pages are accepted */
+} t_numa_heap;
+
+/**
+ * @brief The <code>t_numa</code> <code>struct</code> is a read-mostly table
+ * replicated once per NUMA node. Each replica is an ordinary
+ * <code>t_table</code> whose slot array, properties and keys are allocated
+ * from a heap bound to its node, so a lookup made through the replica of the
+ * calling thread's node touches only local memory. Writes are applied to every
+ * replica. The values themselves are the caller's and are shared, not copied.
+ */
+typedef struct {
+  unsigned long int nodes;      /**< Number of nodes and replicas */
+  t_table ** p_replicas;        /**< One table per node */
+  t_numa_heap ** p_heaps;       /**< Heap backing each replica */
+  int (* p_node)(void * p_context); /**< Returns the caller's node */
+  void * p_context;             /**< State passed to p_node */
+} t_numa;
+
+/**
+ * @brief The <code>ch_numa_heap_create</code> function constructs an empty
+ * heap whose memory will be bound to <code>node</code>, or interleaved across
+ * all <code>nodes</code> nodes if <code>node</code> is
+ * <code>CH_NUMA_INTERLEAVE</code>. Binding is advisory: if the kernel refuses
+ * it, as it will for nodes that do not exist, the memory is used regardless,
+ * so simulated topologies work on single-node machines.
+ *
+ * @param node int The node to bind to, or <code>CH_NUMA_INTERLEAVE</code>
+ * @param nodes unsigned long int Number of nodes in the topology, at most 64
+ * @return t_numa_heap* A pointer to the heap, or <code>NULL</code>
+ */
+t_numa_heap * ch_numa_heap_create(int node, unsigned long int nodes);
+
+/**
+ * @brief The <code>ch_numa_heap_allocator</code> function returns a
+ * <code>t_allocator</code> drawing on <code>p_heap</code>, to be passed to
+ * <code>ch_create_ex</code>. Passing an interleaved heap spreads a single
+ * table's slot array and properties evenly over every node, so that no node's
+ * threads pay remote latency on every lookup.
+ *
+ * @param p_heap t_numa_heap* A pointer to the heap
+ * @return t_allocator The allocator
+ */
+t_allocator ch_numa_heap_allocator(t_numa_heap * p_heap);
+
+/**
+ * @brief The <code>ch_numa_heap_destroy</code> function unmaps every region of
+ * <code>p_heap</code>, and with them every block allocated from it, before
+ * deallocating the heap itself.
+ *
+ * @param p_heap t_numa_heap* A pointer to the heap
+ * @return void
+ */
+void ch_numa_heap_destroy(t_numa_heap * p_heap);
+
+/**
+ * @brief The <code>ch_numa_create</code> function constructs a table with one
+ * replica of <code>table_size</code> slots on each of <code>nodes</code>
+ * nodes. The function <code>p_node</code>, called with
+ * <code>p_context</code>, returns the node of the calling thread, and so
+ * selects the replica each lookup reads; if it is <code>NULL</code>, the node
+ * is asked of the kernel. Supplying it allows a topology to be simulated.
+ *
+ * @param table_size unsigned long int Number of slots in each replica
+ * @param nodes unsigned long int Number of nodes, at most 64
+ * @param p_node int (*)(void*) Returns the caller's node, or <code>NULL</code>
+ * @param p_context void* State passed to <code>p_node</code>
+ * @return t_numa* A pointer to the replicated table, or <code>NULL</code>
+ */
+t_numa * ch_numa_create(unsigned long int table_size, unsigned long int nodes,
+  int (* p_node)(void * p_context), void * p_context);
+
+/**
+ * @brief The <code>ch_numa_put</code> function maps <code>p_key</code> to
+ * <code>p_value</code> in every replica, hashing the key only once. Should any
+ * replica fail to allocate, the key is removed from all of them, so that the
+ * replicas never disagree, and <code>NULL</code> is returned. As with
+ * <code>t_table</code>, writes must not run concurrently with other calls.
+ *
+ * @param p_numa t_numa* A pointer to the replicated table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return void* The value, or <code>NULL</code> if allocation failed
+ */
+void * ch_numa_put(t_numa * p_numa, const char * p_key, void * p_value);
+
+/**
+ * @brief The <code>ch_numa_get</code> function retrieves the value mapped to
+ * <code>p_key</code> from the replica of the calling thread's node. Lookups
+ * modify nothing and may run concurrently with one another.
+ *
+ * @param p_numa t_numa* A pointer to the replicated table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_numa_get(t_numa * p_numa, const char * p_key);
+
+/**
+ * @brief The <code>ch_numa_delete</code> function removes <code>p_key</code>
+ * from every replica and returns the value it was mapped to.
+ *
+ * @param p_numa t_numa* A pointer to the replicated table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_numa_delete(t_numa * p_numa, const char * p_key);
+
+/**
+ * @brief The <code>ch_numa_destroy</code> function destroys every replica and
+ * the heap backing it, then deallocates the replicated table itself.
+ *
+ * @param p_numa t_numa* A pointer to the replicated table
+ * @return void
+ */
+void ch_numa_destroy(t_numa * p_numa);
+
+#endif
@@ -0,0 +1,407 @@
+/**
+ * @file chash_robin.c
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Source file for CHash tables using Robin Hood linear probing
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "chash.h"
+#include "chash_robin.h"
+
+/**
+ * @brief The <code>_home</code> helper function returns the home slot of a key
+ * whose hash is <code>hash</code>, first scrambling the hash with the
+ * SplitMix64 finalizer so that keys with consecutive <code>ch_hash</code>
+ * values do not form long runs.
+ *
+ * @param hash unsigned long int The key's hash
+ * @param size unsigned long int Number of slots
+ * @return unsigned long int The index of the key's home slot
+ */
+static unsigned long int _home(unsigned long int hash, unsigned long int size) {
+  hash ^= hash >> 30;
+  hash *= 0xBF58476D1CE4E5B9UL;
+  hash ^= hash >> 27;
+  hash *= 0x94D049BB133111EBUL;
+  return (hash ^ (hash >> 31)) % size;
+}
+
+/**
+ * @brief The <code>_find</code> helper function returns the index of the slot
+ * holding <code>p_key</code>, or <code>size</code> if the key is absent.
+ *
+ * @param p_table t_robin* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key
+ * @param hash unsigned long int The key's hash
+ * @return unsigned long int Index of the key's slot, or the table size
+ */
+static unsigned long int _find(t_robin * p_table, const char * p_key,
+    unsigned long int hash) {
+
+  // Declarations
+  unsigned long int position, distance;
+  t_robin_slot * p_slot;
+
+  // Definition
+  position = _home(hash, p_table->size);
+
+  for (distance = 0; ; distance++) {
+    p_slot = &p_table->p_slots[position];
+
+    // An empty or richer slot means the key would already have been seen
+    if (p_slot->p_key == NULL || p_slot->distance < distance) {
+      return p_table->size;
+    }
+
+    if (p_slot->hash == hash && strcmp(p_slot->p_key, p_key) == 0) {
+      return position;
+    }
+
+    position = (position + 1 == p_table->size) ? 0 : position + 1;
+  }
+}
+
+/**
+ * @brief The <code>_insert</code> helper function places the pair held in
+ * <code>carry</code>, which must not already be present, using the Robin Hood
+ * rule. The running <code>total_distance</code> is kept exact by subtracting
+ * the distance of each displaced resident and adding the distance at which
+ * each pair finally comes to rest.
+ *
+ * @param p_table t_robin* A pointer to the specific hash table
+ * @param carry t_robin_slot The pair to be placed
+ * @return void
+ */
+static void _insert(t_robin * p_table, t_robin_slot carry) {
+
+  // Declarations
+  unsigned long int position;
+  t_robin_slot * p_slot, swap;
+
+  // Definitions
+  position = _home(carry.hash, p_table->size);
+  carry.distance = 0;
+
+  for (;;) {
+    p_slot = &p_table->p_slots[position];
+
+    if (p_slot->p_key == NULL) {
+      *p_slot = carry;
+      p_table->total_distance += carry.distance;
+      return;
+    }
+
+    // Take from the rich: the resident nearer its home yields its slot
+    if (p_slot->distance < carry.distance) {
+      p_table->total_distance += carry.distance - p_slot->distance;
+      swap = *p_slot;
+      *p_slot = carry;
+      carry = swap;
+    }
+
+    position = (position + 1 == p_table->size) ? 0 : position + 1;
+    carry.distance++;
+  }
+}
+
+/**
+ * @brief The <code>_grow</code> helper function doubles the slot array and
+ * reinserts every pair using its cached hash.
+ *
+ * @param p_table t_robin* A pointer to the specific hash table
+ * @return int 1 on success, 0 if allocation failed
+ */
+static int _grow(t_robin * p_table) {
+
+  // Declarations
+  t_robin_slot * p_previous;
+  unsigned long int size, counter;
+
+  // Definitions
+  p_previous = p_table->p_slots;
+  size = p_table->size;
+
+  if ((p_table->p_slots = calloc(size * 2, sizeof(t_robin_slot))) == NULL) {
+    p_table->p_slots = p_previous;
+    return 0;
+  }
+
+  p_table->size = size * 2;
+  p_table->total_distance = 0;
+
+  for (counter = 0; counter < size; counter++) {
+    if (p_previous[counter].p_key != NULL) {
+      _insert(p_table, p_previous[counter]);
+    }
+  }
+
+  free(p_previous);
+  return 1;
+}
+
+/**
+ * @brief The <code>ch_robin_create</code> function constructs an empty Robin
+ * Hood table of <code>table_size</code> slots. The table doubles whenever it
+ * would otherwise exceed a load factor of 90 percent.
+ *
+ * @param table_size unsigned long int Initial number of slots
+ * @return t_robin* A pointer to the specific hash table
+ */
+t_robin * ch_robin_create(unsigned long int table_size) {
+
+  // Declaration
+  t_robin * p_table;
+
+  if ((p_table = malloc(sizeof(t_robin))) == NULL) {
+    return NULL;
+  }
+
+  p_table->size = (table_size > 1) ? table_size : 2;
+  p_table->count = 0;
+  p_table->total_distance = 0;
+
+  if ((p_table->p_slots = calloc(p_table->size, sizeof(t_robin_slot))) ==
+      NULL) {
+    free(p_table);
+    return NULL;
+  }
+
+  return p_table;
+}
+
+/**
+ * @brief The <code>ch_robin_put</code> function maps <code>p_key</code> to
+ * <code>p_value</code>, updating the value if the key is already present, as
+ * <code>ch_put</code> does. While probing for a free slot, a new pair takes the
+ * slot of any resident lying closer to its own home than the new pair does to
+ * its home, and the displaced resident continues the probe in its place. This
+ * keeps the spread of probe lengths narrow.
+ *
+ * @param p_table t_robin* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return void* The value, or <code>NULL</code> if allocation failed
+ */
+void * ch_robin_put(t_robin * p_table, const char * p_key, void * p_value) {
+
+  // Declarations
+  unsigned long int position;
+  t_robin_slot carry;
+
+  // Update value of extant pair
+  carry.hash = ch_hash(p_key);
+
+  if ((position = _find(p_table, p_key, carry.hash)) != p_table->size) {
+    p_table->p_slots[position].p_value = p_value;
+    return p_value;
+  }
+
+  // Keep the load factor at or below 90 percent
+  if ((p_table->count + 1) * 10 > p_table->size * 9 && !_grow(p_table)) {
+    return NULL;
+  }
+
+  if ((carry.p_key = malloc(strlen(p_key) + 1)) == NULL) {
+    return NULL;
+  }
+
+  strcpy(carry.p_key, p_key);
+  carry.p_value = p_value;
+  _insert(p_table, carry);
+  p_table->count++;
+
+  return p_value;
+}
+
+/**
+ * @brief The <code>ch_robin_get</code> function retrieves the value mapped to
+ * <code>p_key</code>. The probe stops as soon as it reaches a slot lying closer
+ * to its own home than the probe is to the key's, since by the Robin Hood
+ * invariant the key cannot lie beyond it.
+ *
+ * @param p_table t_robin* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_robin_get(t_robin * p_table, const char * p_key) {
+
+  // Declaration
+  unsigned long int position;
+
+  position = _find(p_table, p_key, ch_hash(p_key));
+
+  return (position != p_table->size) ? p_table->p_slots[position].p_value
+    : NULL;
+}
+
+/**
+ * @brief The <code>ch_robin_delete</code> function removes the pair mapped to
+ * <code>p_key</code> and returns its value. Rather than leaving a tombstone,
+ * it shifts each following pair back by one slot until it reaches an empty
+ * slot or a pair already in its home slot. No trace of the deletion remains,
+ * so probe lengths do not creep upward under sustained insert/delete churn.
+ *
+ * @param p_table t_robin* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_robin_delete(t_robin * p_table, const char * p_key) {
+
+  // Declarations
+  unsigned long int position, next;
+  void * p_value_storage;
+
+  if ((position = _find(p_table, p_key, ch_hash(p_key))) == p_table->size) {
+    return NULL;
+  }
+
+  p_value_storage = p_table->p_slots[position].p_value;
+  p_table->total_distance -= p_table->p_slots[position].distance;
+  free(p_table->p_slots[position].p_key);
+
+  // Shift the following run back by one, each pair a step nearer its home
+  for (;;) {
+    next = (position + 1 == p_table->size) ? 0 : position + 1;
+
+    if (p_table->p_slots[next].p_key == NULL ||
+        p_table->p_slots[next].distance == 0) {
+      break;
+    }
+
+    p_table->p_slots[position] = p_table->p_slots[next];
+    p_table->p_slots[position].distance--;
+    p_table->total_distance--;
+    position = next;
+  }
+
+  memset(&p_table->p_slots[position], 0, sizeof(t_robin_slot));
+  p_table->count--;
+
+  return p_value_storage;
+}
+
+/**
+ * @brief The <code>ch_robin_clone</code> function constructs a copy of
+ * <code>p_table</code>. The flat slot array, cached hashes and distances
+ * included, is copied wholesale with a single <code>memcpy</code>, so that
+ * no key is rehashed or reinserted; only the keys themselves are then
+ * duplicated. The values are shared.
+ *
+ * @param p_table t_robin* A pointer to the hash table to be copied
+ * @return t_robin* A pointer to the copy, or <code>NULL</code>
+ */
+t_robin * ch_robin_clone(t_robin * p_table) {
+
+  // Declarations
+  t_robin * p_clone;
+  t_robin_slot * p_slot;
+  unsigned long int counter;
+  char * p_key;
+
+  if ((p_clone = malloc(sizeof(t_robin))) == NULL) {
+    return NULL;
+  }
+
+  *p_clone = *p_table;
+
+  if ((p_clone->p_slots = malloc(sizeof(t_robin_slot) * p_table->size)) ==
+      NULL) {
+    free(p_clone);
+    return NULL;
+  }
+
+  memcpy(p_clone->p_slots, p_table->p_slots,
+    sizeof(t_robin_slot) * p_table->size);
+
+  for (counter = 0; counter < p_clone->size; counter++) {
+    p_slot = &p_clone->p_slots[counter];
+
+    if (p_slot->p_key == NULL) {
+      continue;
+    }
+
+    if ((p_key = malloc(strlen(p_slot->p_key) + 1)) == NULL) {
+
+      // Disown the keys not yet duplicated before destroying the copy
+      for (; counter < p_clone->size; counter++) {
+        p_clone->p_slots[counter].p_key = NULL;
+      }
+
+      ch_robin_destroy(p_clone);
+      return NULL;
+    }
+
+    p_slot->p_key = strcpy(p_key, p_slot->p_key);
+  }
+
+  return p_clone;
+}
+
+/**
+ * @brief The <code>ch_robin_stats</code> function reports the size, count and
+ * probe lengths of <code>p_table</code>. The average is computed from the
+ * running total kept by the table; the maximum requires a scan of the slots.
+ *
+ * @param p_table t_robin* A pointer to the specific hash table
+ * @param p_stats t_robin_stats* Receives the statistics
+ * @return void
+ */
+void ch_robin_stats(t_robin * p_table, t_robin_stats * p_stats) {
+
+  // Declaration
+  unsigned long int counter;
+
+  p_stats->size = p_table->size;
+  p_stats->count = p_table->count;
+  p_stats->max_probe = 0;
+  p_stats->average_probe = (p_table->count == 0) ? 0 :
+    1.0 + (double) p_table->total_distance / p_table->count;
+
+  for (counter = 0; counter < p_table->size; counter++) {
+    if (p_table->p_slots[counter].p_key != NULL &&
+        p_table->p_slots[counter].distance + 1 > p_stats->max_probe) {
+      p_stats->max_probe = p_table->p_slots[counter].distance + 1;
+    }
+  }
+}
+
+/**
+ * @brief The <code>ch_robin_clear</code> function deallocates every key in the
+ * table and empties every slot.
+ *
+ * @param p_table t_robin* A pointer to the specific hash table
+ * @return void
+ */
+void ch_robin_clear(t_robin * p_table) {
+
+  // Declaration
+  unsigned long int counter;
+
+  for (counter = 0; counter < p_table->size; counter++) {
+    free(p_table->p_slots[counter].p_key);
+  }
+
+  memset(p_table->p_slots, 0, sizeof(t_robin_slot) * p_table->size);
+  p_table->count = 0;
+  p_table->total_distance = 0;
+}
+
+/**
+ * @brief The <code>ch_robin_destroy</code> function clears the table, then
+ * deallocates its slots and the table itself.
+ *
+ * @param p_table t_robin* A pointer to the specific hash table
+ * @return void
+ */
+void ch_robin_destroy(t_robin * p_table) {
+
+  if (p_table == NULL) {
+    return;
+  }
+
+  ch_robin_clear(p_table);
+  free(p_table->p_slots);
+  free(p_table);
+}
@@ -0,0 +1,142 @@
+/**
+ * @file chash_robin.h
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Header file for CHash tables using Robin Hood linear probing
+ */
+
+#ifndef __CHASH_ROBIN_H_
+#define __CHASH_ROBIN_H_
+
+/**
+ * @brief The <code>t_robin_slot</code> <code>struct</code> is one slot of the
+ * flat array of a <code>t_robin</code>. The <code>distance</code> member
+ * records how far the slot lies past its key's home slot, which is all that
+ * the Robin Hood insertion and backward-shift deletion rules need.
+ */
+typedef struct {
+  char * p_key;                 /**< Key, or <code>NULL</code> if empty */
+  void * p_value;               /**< Void pointer representing the value */
+  unsigned long int hash;       /**< Cached hash of the key string */
+  unsigned long int distance;   /**< Distance from the key's home slot */
+} t_robin_slot;
+
+/**
+ * @brief The <code>t_robin</code> <code>struct</code> is a linear-probing hash
+ * table over the flat array <code>p_slots</code>. Alongside the number of
+ * pairs stored, it keeps <code>total_distance</code>, the sum of the
+ * <code>distance</code> members of all occupied slots, so that the mean probe
+ * length is available at any time without a scan.
+ */
+typedef struct {
+  unsigned long int size;       /**< Number of slots */
+  unsigned long int count;      /**< Number of key/value pairs stored */
+  unsigned long int total_distance; /**< Sum of all occupied distances */
+  t_robin_slot * p_slots;       /**< Flat array of slots */
+} t_robin;
+
+/**
+ * @brief The <code>t_robin_stats</code> <code>struct</code> is filled in by
+ * <code>ch_robin_stats</code>. A successful lookup of a key inspects
+ * <code>distance + 1</code> slots, so <code>average_probe</code> is the mean
+ * number of slots inspected by a successful lookup.
+ */
+typedef struct {
+  unsigned long int size;       /**< Number of slots */
+  unsigned long int count;      /**< Number of key/value pairs stored */
+  unsigned long int max_probe;  /**< Largest number of slots inspected */
+  double average_probe;         /**< Mean number of slots inspected */
+} t_robin_stats;
+
+/**
+ * @brief The <code>ch_robin_create</code> function constructs an empty Robin
+ * Hood table of <code>table_size</code> slots. The table doubles whenever it
+ * would otherwise exceed a load factor of 90 percent.
+ *
+ * @param table_size unsigned long int Initial number of slots
+ * @return t_robin* A pointer to the specific hash table
+ */
+t_robin * ch_robin_create(unsigned long int table_size);
+
+/**
+ * @brief The <code>ch_robin_put</code> function maps <code>p_key</code> to
+ * <code>p_value</code>, updating the value if the key is already present, as
+ * <code>ch_put</code> does. While probing for a free slot, a new pair takes the
+ * slot of any resident lying closer to its own home than the new pair does to
+ * its home, and the displaced resident continues the probe in its place. This
+ * keeps the spread of probe lengths narrow.
+ *
+ * @param p_table t_robin* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value void* A void pointer to the address of the associated value
+ * @return void* The value, or <code>NULL</code> if allocation failed
+ */
+void * ch_robin_put(t_robin * p_table, const char * p_key, void * p_value);
+
+/**
+ * @brief The <code>ch_robin_get</code> function retrieves the value mapped to
+ * <code>p_key</code>. The probe stops as soon as it reaches a slot lying closer
+ * to its own home than the probe is to the key's, since by the Robin Hood
+ * invariant the key cannot lie beyond it.
+ *
+ * @param p_table t_robin* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_robin_get(t_robin * p_table, const char * p_key);
+
+/**
+ * @brief The <code>ch_robin_delete</code> function removes the pair mapped to
+ * <code>p_key</code> and returns its value. Rather than leaving a tombstone,
+ * it shifts each following pair back by one slot until it reaches an empty
+ * slot or a pair already in its home slot. No trace of the deletion remains,
+ * so probe lengths do not creep upward under sustained insert/delete churn.
+ *
+ * @param p_table t_robin* A pointer to the specific hash table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return void* A void pointer representing the value of the key/value pair
+ */
+void * ch_robin_delete(t_robin * p_table, const char * p_key);
+
+/**
+ * @brief The <code>ch_robin_clone</code> function constructs a copy of
+ * <code>p_table</code>. The flat slot array, cached hashes and distances
+ * included, is copied wholesale with a single <code>memcpy</code>, so that
+ * no key is rehashed or reinserted; only the keys themselves are then
+ * duplicated. The values are shared.
+ *
+ * @param p_table t_robin* A pointer to the hash table to be copied
+ * @return t_robin* A pointer to the copy, or <code>NULL</code>
+ */
+t_robin * ch_robin_clone(t_robin * p_table);
+
+/**
+ * @brief The <code>ch_robin_stats</code> function reports the size, count and
+ * probe lengths of <code>p_table</code>. The average is computed from the
+ * running total kept by the table; the maximum requires a scan of the slots.
+ *
+ * @param p_table t_robin* A pointer to the specific hash table
+ * @param p_stats t_robin_stats* Receives the statistics
+ * @return void
+ */
+void ch_robin_stats(t_robin * p_table, t_robin_stats * p_stats);
+
+/**
+ * @brief The <code>ch_robin_clear</code> function deallocates every key in the
+ * table and empties every slot.
+ *
+ * @param p_table t_robin* A pointer to the specific hash table
+ * @return void
+ */
+void ch_robin_clear(t_robin * p_table);
+
+/**
+ * @brief The <code>ch_robin_destroy</code> function clears the table, then
+ * deallocates its slots and the table itself.
+ *
+ * @param p_table t_robin* A pointer to the specific hash table
+ * @return void
+ */
+void ch_robin_destroy(t_robin * p_table);
+
+#endif
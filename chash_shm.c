@@ -0,0 +1,532 @@
+/**
+ * @file chash_shm.c
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Source file for CHash tables shared between processes in POSIX
+ * shared memory
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "chash.h"
+#include "chash_shm.h"
+
+/**
+ * @brief Magic string written at the start of every shared segment
+ */
+static const char MAGIC[8] = {'C', 'H', 'A', 'S', 'H', 'S', 'H', '1'};
+
+/**
+ * @brief The <code>_class</code> helper function returns the smallest size
+ * class whose blocks can hold a record of <code>length</code> bytes.
+ *
+ * @param length uint64_t Length of the record, header included
+ * @return int The size class, or -1 if no class is large enough
+ */
+static int _class(uint64_t length) {
+
+  // Declaration
+  int size_class;
+
+  for (size_class = 0; size_class < CH_SHM_CLASSES; size_class++) {
+    if (((uint64_t) 32 << size_class) >= length) {
+      return size_class;
+    }
+  }
+
+  return -1;
+}
+
+/**
+ * @brief The <code>_record</code> helper function converts the offset
+ * <code>offset</code> into a pointer to the record lying there.
+ *
+ * @param p_shm t_shm* A pointer to the specific table
+ * @param offset uint64_t Offset of the record from the start of the segment
+ * @return t_shm_record* The record
+ */
+static t_shm_record * _record(t_shm * p_shm, uint64_t offset) {
+  return (t_shm_record *) (p_shm->p_base + offset);
+}
+
+/**
+ * @brief The <code>_begin</code> helper function opens a write by making the
+ * sequence odd. The release fence keeps the writes that follow from becoming
+ * visible before the odd sequence does.
+ *
+ * @param p_shm t_shm* A pointer to the writable table
+ * @return void
+ */
+static void _begin(t_shm * p_shm) {
+  atomic_store_explicit(&p_shm->p_header->sequence,
+    atomic_load_explicit(&p_shm->p_header->sequence, memory_order_relaxed) + 1,
+    memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+}
+
+/**
+ * @brief The <code>_end</code> helper function closes a write by making the
+ * sequence even again, releasing every write made since <code>_begin</code>.
+ *
+ * @param p_shm t_shm* A pointer to the writable table
+ * @return void
+ */
+static void _end(t_shm * p_shm) {
+  atomic_store_explicit(&p_shm->p_header->sequence,
+    atomic_load_explicit(&p_shm->p_header->sequence, memory_order_relaxed) + 1,
+    memory_order_release);
+}
+
+/**
+ * @brief The <code>_find</code> helper function is the writer's lookup. It
+ * returns the offset of the record holding <code>p_key</code> and stores in
+ * <code>pp_link</code> the address of the link referring to it, so that the
+ * record may be unlinked. Being the only process that modifies the segment,
+ * the writer needs no seqlock to read it.
+ *
+ * @param p_shm t_shm* A pointer to the writable table
+ * @param p_key const char* A string representing the key
+ * @param hash uint64_t The key's hash
+ * @param pp_link uint64_t** Receives the address of the link to the record
+ * @return uint64_t Offset of the record, or 0 if the key is absent
+ */
+static uint64_t _find(t_shm * p_shm, const char * p_key, uint64_t hash,
+    uint64_t ** pp_link) {
+
+  // Declaration
+  t_shm_record * p_record;
+
+  *pp_link = &p_shm->p_buckets[hash % p_shm->size];
+
+  while (**pp_link != 0) {
+    p_record = _record(p_shm, **pp_link);
+
+    if (p_record->hash == hash &&
+        strcmp((const char *) (p_record + 1), p_key) == 0) {
+      return **pp_link;
+    }
+
+    *pp_link = &p_record->next;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief The <code>_allocate</code> helper function takes a block of class
+ * <code>size_class</code> from that class's free list, or failing that from
+ * the arena's unused tail. It must be called between <code>_begin</code> and
+ * <code>_end</code>, as a reused block may still be under a reader's eye.
+ *
+ * @param p_shm t_shm* A pointer to the writable table
+ * @param size_class int Size class of the block
+ * @return uint64_t Offset of the block, or 0 if the arena is full
+ */
+static uint64_t _allocate(t_shm * p_shm, int size_class) {
+
+  // Declarations
+  t_shm_header * p_header;
+  uint64_t offset;
+
+  // Definition
+  p_header = p_shm->p_header;
+
+  if ((offset = p_header->free[size_class]) != 0) {
+    p_header->free[size_class] = _record(p_shm, offset)->next;
+    return offset;
+  }
+
+  if (p_shm->length - p_header->top < ((uint64_t) 32 << size_class)) {
+    return 0;
+  }
+
+  offset = p_header->top;
+  p_header->top += (uint64_t) 32 << size_class;
+
+  return offset;
+}
+
+/**
+ * @brief The <code>_release</code> helper function pushes the block at
+ * <code>offset</code> onto the free list of its size class.
+ *
+ * @param p_shm t_shm* A pointer to the writable table
+ * @param offset uint64_t Offset of the block
+ * @return void
+ */
+static void _release(t_shm * p_shm, uint64_t offset) {
+
+  // Declaration
+  t_shm_record * p_record;
+
+  // Definition
+  p_record = _record(p_shm, offset);
+
+  p_record->next = p_shm->p_header->free[p_record->size_class];
+  p_shm->p_header->free[p_record->size_class] = offset;
+}
+
+/**
+ * @brief The <code>_handle</code> helper function allocates the handle for a
+ * mapping of <code>length</code> bytes at <code>p_base</code>.
+ *
+ * @param p_base void* Base address of the mapping
+ * @param length unsigned long int Length of the mapping in bytes
+ * @param writable int Nonzero if the mapping is the writer's
+ * @return t_shm* The handle, or <code>NULL</code> if allocation failed
+ */
+static t_shm * _handle(void * p_base, unsigned long int length,
+    int writable) {
+
+  // Declaration
+  t_shm * p_shm;
+
+  if ((p_shm = malloc(sizeof(t_shm))) == NULL) {
+    return NULL;
+  }
+
+  p_shm->p_base = p_base;
+  p_shm->length = length;
+  p_shm->p_header = p_base;
+  p_shm->size = p_shm->p_header->size;
+  p_shm->p_buckets = (uint64_t *) (p_shm->p_header + 1);
+  p_shm->writable = writable;
+
+  return p_shm;
+}
+
+/**
+ * @brief The <code>ch_shm_create</code> function creates the shared memory
+ * object named <code>p_name</code>, which must not already exist, sizes it to
+ * <code>length</code> bytes and maps it read-write as an empty table of
+ * <code>table_size</code> buckets. The process creating the segment is its
+ * sole writer; keys and values are copied into the segment, whose arena does
+ * not grow, so <code>length</code> bounds the total they may occupy.
+ *
+ * @param p_name const char* Name of the shared memory object, such as "/cache"
+ * @param table_size unsigned long int Number of buckets
+ * @param length unsigned long int Total length of the segment in bytes
+ * @return t_shm* A handle to the writable table, or <code>NULL</code> on
+ * failure
+ */
+t_shm * ch_shm_create(const char * p_name, unsigned long int table_size,
+    unsigned long int length) {
+
+  // Declarations
+  t_shm * p_shm;
+  t_shm_header * p_header;
+  void * p_base;
+  int descriptor;
+
+  // The header and buckets must leave room for at least one block
+  if (length < sizeof(t_shm_header) + 32 || table_size == 0 ||
+      table_size > (length - sizeof(t_shm_header) - 32) / sizeof(uint64_t)) {
+    return NULL;
+  }
+
+  if ((descriptor = shm_open(p_name, O_CREAT | O_EXCL | O_RDWR, 0644)) < 0) {
+    return NULL;
+  }
+
+  // A freshly truncated object reads as zeroes, emptying every bucket
+  if (ftruncate(descriptor, length) != 0) {
+    close(descriptor);
+    shm_unlink(p_name);
+    return NULL;
+  }
+
+  p_base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor,
+    0);
+  close(descriptor);
+
+  if (p_base == MAP_FAILED) {
+    shm_unlink(p_name);
+    return NULL;
+  }
+
+  p_header = p_base;
+  p_header->size = table_size;
+  p_header->length = length;
+  p_header->count = 0;
+  p_header->top = (sizeof(t_shm_header) + table_size * sizeof(uint64_t) + 7) &
+    ~((uint64_t) 7);
+  atomic_init(&p_header->sequence, 0);
+
+  // Publish the magic last, so readers never accept a half-built header
+  atomic_thread_fence(memory_order_release);
+  memcpy(p_header->magic, MAGIC, sizeof(MAGIC));
+
+  if ((p_shm = _handle(p_base, length, 1)) == NULL) {
+    munmap(p_base, length);
+    shm_unlink(p_name);
+    return NULL;
+  }
+
+  return p_shm;
+}
+
+/**
+ * @brief The <code>ch_shm_open</code> function maps an existing segment
+ * created by <code>ch_shm_create</code> read-only and validates its header.
+ * The pages are those of the writer, so the memory is shared by every reader
+ * rather than duplicated.
+ *
+ * @param p_name const char* Name of the shared memory object
+ * @return t_shm* A handle to the read-only table, or <code>NULL</code> on
+ * failure
+ */
+t_shm * ch_shm_open(const char * p_name) {
+
+  // Declarations
+  t_shm * p_shm;
+  t_shm_header * p_header;
+  struct stat status;
+  void * p_base;
+  int descriptor;
+
+  if ((descriptor = shm_open(p_name, O_RDONLY, 0)) < 0) {
+    return NULL;
+  }
+
+  if (fstat(descriptor, &status) != 0 ||
+      (unsigned long int) status.st_size < sizeof(t_shm_header)) {
+    close(descriptor);
+    return NULL;
+  }
+
+  p_base = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+  close(descriptor);
+
+  if (p_base == MAP_FAILED) {
+    return NULL;
+  }
+
+  // Validate magic, declared length and bucket array bounds
+  p_header = p_base;
+  atomic_thread_fence(memory_order_acquire);
+
+  if (memcmp(p_header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      p_header->length != (uint64_t) status.st_size || p_header->size == 0 ||
+      p_header->size > (status.st_size - sizeof(t_shm_header)) /
+        sizeof(uint64_t)) {
+    munmap(p_base, status.st_size);
+    return NULL;
+  }
+
+  if ((p_shm = _handle(p_base, status.st_size, 0)) == NULL) {
+    munmap(p_base, status.st_size);
+    return NULL;
+  }
+
+  return p_shm;
+}
+
+/**
+ * @brief The <code>ch_shm_put</code> function copies <code>value_length</code>
+ * bytes at <code>p_value</code> into the segment under <code>p_key</code>,
+ * replacing any previous value. A value that fits the key's existing block is
+ * overwritten in place; otherwise a new record is linked in before the old
+ * one is released. Only the handle returned by <code>ch_shm_create</code> may
+ * be used, and from only one thread at a time.
+ *
+ * @param p_shm t_shm* A pointer to the writable table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value const void* Address of the value bytes to be copied
+ * @param value_length unsigned long int Number of value bytes
+ * @return int 0 on success, -1 if the handle is read-only or the arena is full
+ */
+int ch_shm_put(t_shm * p_shm, const char * p_key, const void * p_value,
+    unsigned long int value_length) {
+
+  // Declarations
+  t_shm_record * p_record;
+  uint64_t hash, key_length, extant, offset, * p_link;
+  int size_class;
+
+  // Definitions
+  hash = ch_hash(p_key);
+  key_length = strlen(p_key);
+  size_class = _class(sizeof(t_shm_record) + key_length + 1 + value_length);
+
+  if (!p_shm->writable || size_class < 0 || key_length > UINT32_MAX ||
+      value_length > UINT32_MAX) {
+    return -1;
+  }
+
+  extant = _find(p_shm, p_key, hash, &p_link);
+  _begin(p_shm);
+
+  // Overwrite in place if the extant block is large enough
+  if (extant != 0 && _record(p_shm, extant)->size_class >= (uint32_t)
+      size_class) {
+    p_record = _record(p_shm, extant);
+    memcpy((char *) (p_record + 1) + key_length + 1, p_value, value_length);
+    p_record->value_length = value_length;
+    _end(p_shm);
+    return 0;
+  }
+
+  if ((offset = _allocate(p_shm, size_class)) == 0) {
+    _end(p_shm);
+    return -1;
+  }
+
+  p_record = _record(p_shm, offset);
+  p_record->hash = hash;
+  p_record->key_length = key_length;
+  p_record->value_length = value_length;
+  p_record->size_class = size_class;
+  memcpy(p_record + 1, p_key, key_length + 1);
+  memcpy((char *) (p_record + 1) + key_length + 1, p_value, value_length);
+
+  // Take the extant record's place in its bucket, or push onto the head
+  if (extant != 0) {
+    p_record->next = _record(p_shm, extant)->next;
+    *p_link = offset;
+    _release(p_shm, extant);
+  } else {
+    p_record->next = p_shm->p_buckets[hash % p_shm->size];
+    p_shm->p_buckets[hash % p_shm->size] = offset;
+    p_shm->p_header->count++;
+  }
+
+  _end(p_shm);
+  return 0;
+}
+
+/**
+ * @brief The <code>ch_shm_get</code> function copies the value mapped to
+ * <code>p_key</code> into <code>p_buffer</code>, truncated to
+ * <code>capacity</code> bytes, and returns its full length. Pointers into the
+ * segment are never handed out, since the writer may reuse a record's block
+ * as soon as the lookup ends. Should the writer modify the table during the
+ * lookup, the copy is discarded and the lookup repeated, so the bytes returned
+ * are always those of a single consistent version of the value.
+ *
+ * @param p_shm t_shm* A pointer to the specific table
+ * @param p_key const char* A string representing the key of the desired value
+ * @param p_buffer void* Receives the value bytes
+ * @param capacity unsigned long int Size of the buffer in bytes
+ * @return long int Length of the value, or -1 if the key is absent
+ */
+long int ch_shm_get(t_shm * p_shm, const char * p_key, void * p_buffer,
+    unsigned long int capacity) {
+
+  // Declarations
+  t_shm_record * p_record;
+  uint64_t hash, key_length, offset, steps, before;
+  long int result;
+
+  // Definitions
+  hash = ch_hash(p_key);
+  key_length = strlen(p_key);
+
+  for (;;) {
+    before = atomic_load_explicit(&p_shm->p_header->sequence,
+      memory_order_acquire);
+
+    if (before & 1) {
+      continue;
+    }
+
+    result = -1;
+    offset = p_shm->p_buckets[hash % p_shm->size];
+
+    // A torn read may yield any offset, so each one is checked before use
+    for (steps = 0; offset != 0 && steps < p_shm->length / 32; steps++) {
+      if (offset % 8 != 0 || offset > p_shm->length - sizeof(t_shm_record)) {
+        break;
+      }
+
+      p_record = _record(p_shm, offset);
+
+      if ((uint64_t) p_record->key_length + p_record->value_length + 1 >
+          p_shm->length - offset - sizeof(t_shm_record)) {
+        break;
+      }
+
+      if (p_record->hash == hash && p_record->key_length == key_length &&
+          memcmp(p_record + 1, p_key, key_length) == 0) {
+        result = p_record->value_length;
+        memcpy(p_buffer, (char *) (p_record + 1) + key_length + 1,
+          (unsigned long int) result < capacity ? (unsigned long int) result
+            : capacity);
+        break;
+      }
+
+      offset = p_record->next;
+    }
+
+    // Accept the result only if no write began or ended meanwhile
+    atomic_thread_fence(memory_order_acquire);
+
+    if (atomic_load_explicit(&p_shm->p_header->sequence,
+        memory_order_relaxed) == before) {
+      return result;
+    }
+  }
+}
+
+/**
+ * @brief The <code>ch_shm_delete</code> function unlinks the record mapped to
+ * <code>p_key</code> and returns its block to the free list of its size class.
+ * As with <code>ch_shm_put</code>, only the writer may call it.
+ *
+ * @param p_shm t_shm* A pointer to the writable table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return int 0 if the key was deleted, -1 if it was absent or read-only
+ */
+int ch_shm_delete(t_shm * p_shm, const char * p_key) {
+
+  // Declarations
+  uint64_t offset, * p_link;
+
+  if (!p_shm->writable ||
+      (offset = _find(p_shm, p_key, ch_hash(p_key), &p_link)) == 0) {
+    return -1;
+  }
+
+  _begin(p_shm);
+  *p_link = _record(p_shm, offset)->next;
+  _release(p_shm, offset);
+  p_shm->p_header->count--;
+  _end(p_shm);
+
+  return 0;
+}
+
+/**
+ * @brief The <code>ch_shm_close</code> function unmaps the segment and
+ * deallocates the handle. The segment itself persists until
+ * <code>ch_shm_unlink</code> is called and every process has closed it.
+ *
+ * @param p_shm t_shm* A pointer to the specific table
+ * @return void
+ */
+void ch_shm_close(t_shm * p_shm) {
+
+  if (p_shm == NULL) {
+    return;
+  }
+
+  munmap(p_shm->p_base, p_shm->length);
+  free(p_shm);
+}
+
+/**
+ * @brief The <code>ch_shm_unlink</code> function removes the name
+ * <code>p_name</code>, so that no further process may open the segment. Those
+ * which already have it mapped are unaffected.
+ *
+ * @param p_name const char* Name of the shared memory object
+ * @return int 0 on success, -1 on failure
+ */
+int ch_shm_unlink(const char * p_name) {
+  return shm_unlink(p_name);
+}
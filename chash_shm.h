@@ -0,0 +1,169 @@
+/**
+ * @file chash_shm.h
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Header file for CHash tables shared between processes in POSIX
+ * shared memory
+ */
+
+#ifndef __CHASH_SHM_H_
+#define __CHASH_SHM_H_
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/**
+ * @brief Number of block size classes in the segment's arena. Class
+ * <code>c</code> holds blocks of <code>32 << c</code> bytes.
+ */
+#define CH_SHM_CLASSES 32
+
+/**
+ * @brief The <code>t_shm_header</code> <code>struct</code> sits at offset zero
+ * of every shared segment. Directly following it is an array of
+ * <code>size</code> bucket heads, and following that the arena from which
+ * records are carved. Every link in the segment is a byte offset from its
+ * start, with zero standing for <code>NULL</code>, so that each process may map
+ * the segment at a different address.
+ *
+ * The <code>sequence</code> member is the seqlock guarding everything after
+ * it: the writer makes it odd before modifying the table and even afterwards,
+ * and a reader retries any lookup during which it was odd or changed.
+ */
+typedef struct {
+  char magic[8];                /**< Always "CHASHSH1" for this layout */
+  uint64_t size;                /**< Number of buckets */
+  uint64_t length;              /**< Total length of the segment in bytes */
+  _Atomic uint64_t sequence;    /**< Seqlock counter, odd while writing */
+  uint64_t count;               /**< Number of key/value pairs stored */
+  uint64_t top;                 /**< Offset of the arena's unused tail */
+  uint64_t free[CH_SHM_CLASSES]; /**< Free list head of each size class */
+} t_shm_header;
+
+/**
+ * @brief The <code>t_shm_record</code> <code>struct</code> heads each block of
+ * the arena holding a key/value pair. It is followed directly by the key, its
+ * NUL terminator and the value bytes. While a block is free, its
+ * <code>next</code> member instead links it into its size class's free list.
+ */
+typedef struct {
+  uint64_t next;                /**< Offset of the next record in the bucket */
+  uint64_t hash;                /**< Cached hash of the key string */
+  uint32_t key_length;          /**< Length of the key, excluding the NUL */
+  uint32_t value_length;        /**< Length of the value in bytes */
+  uint32_t size_class;          /**< Size class of the enclosing block */
+  uint32_t reserved;            /**< Padding to an eight-byte multiple */
+} t_shm_record;
+
+/**
+ * @brief The <code>t_shm</code> <code>struct</code> is a process's handle on a
+ * shared segment, as returned by <code>ch_shm_create</code> or
+ * <code>ch_shm_open</code>. The bucket count and length are copied out of the
+ * header when the segment is mapped, so that a lookup never indexes the
+ * segment using a value another process could change beneath it.
+ */
+typedef struct {
+  unsigned char * p_base;       /**< Base address of the mapping */
+  unsigned long int length;     /**< Length of the mapping in bytes */
+  unsigned long int size;       /**< Number of buckets */
+  t_shm_header * p_header;      /**< Header at the start of the mapping */
+  uint64_t * p_buckets;         /**< Offsets of the first record per bucket */
+  int writable;                 /**< Nonzero if mapped by the writer */
+} t_shm;
+
+/**
+ * @brief The <code>ch_shm_create</code> function creates the shared memory
+ * object named <code>p_name</code>, which must not already exist, sizes it to
+ * <code>length</code> bytes and maps it read-write as an empty table of
+ * <code>table_size</code> buckets. The process creating the segment is its
+ * sole writer; keys and values are copied into the segment, whose arena does
+ * not grow, so <code>length</code> bounds the total they may occupy.
+ *
+ * @param p_name const char* Name of the shared memory object, such as "/cache"
+ * @param table_size unsigned long int Number of buckets
+ * @param length unsigned long int Total length of the segment in bytes
+ * @return t_shm* A handle to the writable table, or <code>NULL</code> on
+ * failure
+ */
+t_shm * ch_shm_create(const char * p_name, unsigned long int table_size,
+  unsigned long int length);
+
+/**
+ * @brief The <code>ch_shm_open</code> function maps an existing segment
+ * created by <code>ch_shm_create</code> read-only and validates its header.
+ * The pages are those of the writer, so the memory is shared by every reader
+ * rather than duplicated.
+ *
+ * @param p_name const char* Name of the shared memory object
+ * @return t_shm* A handle to the read-only table, or <code>NULL</code> on
+ * failure
+ */
+t_shm * ch_shm_open(const char * p_name);
+
+/**
+ * @brief The <code>ch_shm_put</code> function copies <code>value_length</code>
+ * bytes at <code>p_value</code> into the segment under <code>p_key</code>,
+ * replacing any previous value. A value that fits the key's existing block is
+ * overwritten in place; otherwise a new record is linked in before the old
+ * one is released. Only the handle returned by <code>ch_shm_create</code> may
+ * be used, and from only one thread at a time.
+ *
+ * @param p_shm t_shm* A pointer to the writable table
+ * @param p_key const char* A string representing the key of the key/value pair
+ * @param p_value const void* Address of the value bytes to be copied
+ * @param value_length unsigned long int Number of value bytes
+ * @return int 0 on success, -1 if the handle is read-only or the arena is full
+ */
+int ch_shm_put(t_shm * p_shm, const char * p_key, const void * p_value,
+  unsigned long int value_length);
+
+/**
+ * @brief The <code>ch_shm_get</code> function copies the value mapped to
+ * <code>p_key</code> into <code>p_buffer</code>, truncated to
+ * <code>capacity</code> bytes, and returns its full length. Pointers into the
+ * segment are never handed out, since the writer may reuse a record's block
+ * as soon as the lookup ends. Should the writer modify the table during the
+ * lookup, the copy is discarded and the lookup repeated, so the bytes returned
+ * are always those of a single consistent version of the value.
+ *
+ * @param p_shm t_shm* A pointer to the specific table
+ * @param p_key const char* A string representing the key of the desired value
+ * @param p_buffer void* Receives the value bytes
+ * @param capacity unsigned long int Size of the buffer in bytes
+ * @return long int Length of the value, or -1 if the key is absent
+ */
+long int ch_shm_get(t_shm * p_shm, const char * p_key, void * p_buffer,
+  unsigned long int capacity);
+
+/**
+ * @brief The <code>ch_shm_delete</code> function unlinks the record mapped to
+ * <code>p_key</code> and returns its block to the free list of its size class.
+ * As with <code>ch_shm_put</code>, only the writer may call it.
+ *
+ * @param p_shm t_shm* A pointer to the writable table
+ * @param p_key const char* A string representing the key of the desired value
+ * @return int 0 if the key was deleted, -1 if it was absent or read-only
+ */
+int ch_shm_delete(t_shm * p_shm, const char * p_key);
+
+/**
+ * @brief The <code>ch_shm_close</code> function unmaps the segment and
+ * deallocates the handle. The segment itself persists until
+ * <code>ch_shm_unlink</code> is called and every process has closed it.
+ *
+ * @param p_shm t_shm* A pointer to the specific table
+ * @return void
+ */
+void ch_shm_close(t_shm * p_shm);
+
+/**
+ * @brief The <code>ch_shm_unlink</code> function removes the name
+ * <code>p_name</code>, so that no further process may open the segment. Those
+ * which already have it mapped are unaffected.
+ *
+ * @param p_name const char* Name of the shared memory object
+ * @return int 0 on success, -1 on failure
+ */
+int ch_shm_unlink(const char * p_name);
+
+#endif
@@ -0,0 +1,234 @@
+/**
+ * @file chash_template.h
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Header file generating type-specialized CHash tables via macros
+ */
+
+#ifndef __CHASH_TEMPLATE_H_
+#define __CHASH_TEMPLATE_H_
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief The <code>CH_HASH_INTEGER</code> macro is a ready-made hash function
+ * for integral keys. It forwards to <code>ch_hash_integer</code>, whose final
+ * mix spreads sequential or strided keys over the whole table. Any expression
+ * yielding an <code>unsigned long int</code> may be passed to
+ * <code>CHASH_INIT</code> in its place.
+ */
+#define CH_HASH_INTEGER(key) ch_hash_integer((unsigned long int) (key))
+
+/**
+ * @brief The <code>CH_HASH_STRING</code> macro is a ready-made hash function
+ * for <code>char *</code> keys. It forwards to <code>ch_hash_string</code>,
+ * which computes the same hash as the untyped table's <code>_hash</code>.
+ */
+#define CH_HASH_STRING(key) ch_hash_string(key)
+
+/**
+ * @brief The <code>CH_EQUAL_SCALAR</code> macro compares two scalar keys with
+ * the built-in equality operator.
+ */
+#define CH_EQUAL_SCALAR(a, b) ((a) == (b))
+
+/**
+ * @brief The <code>CH_EQUAL_STRING</code> macro compares two <code>char *</code>
+ * keys by content rather than by address.
+ */
+#define CH_EQUAL_STRING(a, b) (strcmp((a), (b)) == 0)
+
+/**
+ * @brief The <code>ch_hash_integer</code> function applies the 64-bit
+ * finalizer of MurmurHash3 to <code>key</code>. A plain multiplication would
+ * leave the low bits of the product depending only on the low bits of the
+ * key, and as generated tables reduce hashes with <code>%</code>, keys
+ * differing only in their high bits would share a slot. Each shift folds the
+ * high bits down before the next multiplication, so every bit of the key
+ * affects every bit of the result.
+ *
+ * @see https://github.com/aappleby/smhasher/wiki/MurmurHash3
+ * @param key unsigned long int The integer to be hashed
+ * @return value unsigned long int The resultant hash value
+ */
+static inline unsigned long int ch_hash_integer(unsigned long int key) {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdUL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53UL;
+  key ^= key >> 33;
+
+  return key;
+}
+
+/**
+ * @brief The <code>ch_hash_string</code> function reproduces the module's
+ * djb2 variant in a form the compiler can inline into generated tables.
+ *
+ * @param p_key const char* The string to be hashed
+ * @return value unsigned long int The resultant hash value
+ */
+static inline unsigned long int ch_hash_string(const char * p_key) {
+
+  // Declaration
+  unsigned long int value;
+
+  // Definition
+  value = 0L;
+
+  while (*p_key != '\0') {
+    value = value * 33 + *p_key++;
+  }
+
+  return value;
+}
+
+/**
+ * @brief The <code>CHASH_INIT</code> macro stamps out a complete hash table
+ * specialized for a single key type, value type, hash function and equality
+ * function, in the manner of klib's khash. Invoking
+ * <code>CHASH_INIT(name, key_type, value_type, hash, equal)</code> at file
+ * scope defines the types <code>t_name_property</code> and
+ * <code>t_name_table</code> together with the functions listed below. The
+ * generated table uses the same algorithm as <code>t_table</code> (a slot
+ * array indexed by hash modulo size, with new keys appended to the tail of
+ * each slot's list), but keys and values are stored by value in the node and
+ * <code>hash</code> and <code>equal</code> are expanded inline, so no void
+ * pointer or function pointer stands between the compiler and the loop.
+ * <br />
+ * <br />
+ * Keys are stored as given. For <code>char *</code> keys, the caller remains
+ * responsible for the lifetime of the strings, as with any other pointer type.
+ * <ul>
+ *   <li><code>t_name_table * ch_name_create(unsigned long int size)</code></li>
+ *   <li><code>value_type * ch_name_put(t_name_table *, key_type, value_type)
+ *   </code> returns the stored value, or <code>NULL</code> if allocation
+ *   failed</li>
+ *   <li><code>value_type * ch_name_get(t_name_table *, key_type)</code>
+ *   returns the stored value, or <code>NULL</code> if absent</li>
+ *   <li><code>int ch_name_delete(t_name_table *, key_type, value_type *)
+ *   </code> returns 1 and writes out the removed value if found</li>
+ *   <li><code>void ch_name_clear(t_name_table *)</code></li>
+ *   <li><code>void ch_name_destroy(t_name_table *)</code></li>
+ * </ul>
+ */
+#define CHASH_INIT(name, key_type, value_type, hash, equal)                   \
+                                                                              \
+  typedef struct s_##name##_property {                                        \
+    key_type key;                                                             \
+    value_type value;                                                         \
+    struct s_##name##_property * p_next;                                      \
+  } t_##name##_property;                                                      \
+                                                                              \
+  typedef struct {                                                            \
+    unsigned long int size;                                                   \
+    t_##name##_property ** p_entries;                                         \
+  } t_##name##_table;                                                         \
+                                                                              \
+  static inline t_##name##_table * ch_##name##_create(                        \
+      unsigned long int table_size) {                                         \
+    t_##name##_table * p_table;                                               \
+                                                                              \
+    if ((p_table = malloc(sizeof(t_##name##_table))) == NULL) {               \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    p_table->size = table_size;                                               \
+    p_table->p_entries = calloc(table_size, sizeof(t_##name##_property *));   \
+                                                                              \
+    if (p_table->p_entries == NULL) {                                         \
+      free(p_table);                                                          \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    return p_table;                                                           \
+  }                                                                           \
+                                                                              \
+  static inline value_type * ch_##name##_put(t_##name##_table * p_table,      \
+      key_type key, value_type value) {                                       \
+    t_##name##_property ** p_link, * p_entry;                                 \
+                                                                              \
+    p_link = &p_table->p_entries[(hash(key)) % p_table->size];                \
+                                                                              \
+    for (; *p_link != NULL; p_link = &(*p_link)->p_next) {                    \
+      if (equal((*p_link)->key, key)) {                                       \
+        (*p_link)->value = value;                                             \
+        return &(*p_link)->value;                                             \
+      }                                                                       \
+    }                                                                         \
+                                                                              \
+    if ((p_entry = malloc(sizeof(t_##name##_property))) == NULL) {            \
+      return NULL;                                                            \
+    }                                                                         \
+                                                                              \
+    p_entry->key = key;                                                       \
+    p_entry->value = value;                                                   \
+    p_entry->p_next = NULL;                                                   \
+    *p_link = p_entry;                                                        \
+                                                                              \
+    return &p_entry->value;                                                   \
+  }                                                                           \
+                                                                              \
+  static inline value_type * ch_##name##_get(t_##name##_table * p_table,      \
+      key_type key) {                                                         \
+    t_##name##_property * p_entry;                                            \
+                                                                              \
+    p_entry = p_table->p_entries[(hash(key)) % p_table->size];                \
+                                                                              \
+    for (; p_entry != NULL; p_entry = p_entry->p_next) {                      \
+      if (equal(p_entry->key, key)) {                                         \
+        return &p_entry->value;                                               \
+      }                                                                       \
+    }                                                                         \
+                                                                              \
+    return NULL;                                                              \
+  }                                                                           \
+                                                                              \
+  static inline int ch_##name##_delete(t_##name##_table * p_table,            \
+      key_type key, value_type * p_value) {                                   \
+    t_##name##_property ** p_link, * p_entry;                                 \
+                                                                              \
+    p_link = &p_table->p_entries[(hash(key)) % p_table->size];                \
+                                                                              \
+    for (; (p_entry = *p_link) != NULL; p_link = &p_entry->p_next) {          \
+      if (equal(p_entry->key, key)) {                                         \
+        if (p_value != NULL) {                                                \
+          *p_value = p_entry->value;                                          \
+        }                                                                     \
+                                                                              \
+        *p_link = p_entry->p_next;                                            \
+        free(p_entry);                                                        \
+        return 1;                                                             \
+      }                                                                       \
+    }                                                                         \
+                                                                              \
+    return 0;                                                                 \
+  }                                                                           \
+                                                                              \
+  static inline void ch_##name##_clear(t_##name##_table * p_table) {          \
+    t_##name##_property * p_entry, * p_next;                                  \
+    unsigned long int counter;                                                \
+                                                                              \
+    for (counter = 0; counter < p_table->size; counter++) {                   \
+      for (p_entry = p_table->p_entries[counter]; p_entry != NULL;            \
+          p_entry = p_next) {                                                 \
+        p_next = p_entry->p_next;                                             \
+        free(p_entry);                                                        \
+      }                                                                       \
+                                                                              \
+      p_table->p_entries[counter] = NULL;                                     \
+    }                                                                         \
+  }                                                                           \
+                                                                              \
+  static inline void ch_##name##_destroy(t_##name##_table * p_table) {        \
+    if (p_table == NULL) {                                                    \
+      return;                                                                 \
+    }                                                                         \
+                                                                              \
+    ch_##name##_clear(p_table);                                               \
+    free(p_table->p_entries);                                                 \
+    free(p_table);                                                            \
+  }
+
+#endif
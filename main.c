@@ -6,10 +6,37 @@
  * functionality of the CHash hash table data structure created by the author
  */
 
+#define _DEFAULT_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <inttypes.h>
 #include "chash.h"
+#include "chash_mmap.h"
+#include "chash_freeze.h"
+#include "chash_line.h"
+#include "chash_cuckoo.h"
+#include "chash_hopscotch.h"
+#include "chash_robin.h"
+#include "chash_shm.h"
+#include "chash_arena.h"
+#include "chash_numa.h"
+#include "chash_hamt.h"
+#include "chash_template.h"
+
+/**
+ * @brief Typed table from integer identifiers to prices, generated by
+ * <code>CHASH_INIT</code>
+ */
+CHASH_INIT(price, long int, double, CH_HASH_INTEGER, CH_EQUAL_SCALAR)
+
+/**
+ * @brief Typed table from words to counts, generated by
+ * <code>CHASH_INIT</code>
+ */
+CHASH_INIT(word, const char *, int, CH_HASH_STRING, CH_EQUAL_STRING)
 
 /**
  * @brief Given that the author is under the impression that the hash table
@@ -50,6 +77,95 @@ static void _print_hash_table(t_table * p_ht) {
   }
 }
 
+/**
+ * @brief The <code>_string_size</code> function reports the number of bytes
+ * occupied by a string value, terminator included, so that
+ * <code>ch_mmap_write</code> can copy string values into its file and a table
+ * with a budget can charge for them.
+ *
+ * @param p_value const void* The string value
+ * @return unsigned long int Length of the string plus its terminator
+ */
+static unsigned long int _string_size(const void * p_value) {
+  return strlen(p_value) + 1;
+}
+
+/**
+ * @brief The <code>_print_expired</code> function is installed as a table's
+ * <code>p_expire</code> hook so that the driver shows each key as it is
+ * dropped on expiry.
+ *
+ * @param p_key const char* The key of the expired property
+ * @param p_value void* The value of the expired property
+ * @return void
+ */
+static void _print_expired(const char * p_key, void * p_value) {
+  printf("Expired       : \"%s\" (0x%" PRIXPTR ")\n", p_key,
+    (uintptr_t) p_value);
+}
+
+/**
+ * @brief The <code>_print_evicted</code> function is installed as a table's
+ * <code>p_evict</code> hook so that the driver shows each key as it is evicted
+ * to make room.
+ *
+ * @param p_key const char* The key of the evicted property
+ * @param p_value void* The value of the evicted property
+ * @return void
+ */
+static void _print_evicted(const char * p_key, void * p_value) {
+  printf("Evicted       : \"%s\" (0x%" PRIXPTR ")\n", p_key,
+    (uintptr_t) p_value);
+}
+
+/**
+ * @brief The <code>_node</code> function is passed to
+ * <code>ch_numa_create</code> to simulate a topology, reporting as the
+ * caller's node whichever the driver has stored at <code>p_context</code>.
+ *
+ * @param p_context void* Address of the simulated node number
+ * @return int The simulated node of the caller
+ */
+static int _node(void * p_context) {
+  return *(int *) p_context;
+}
+
+/**
+ * @brief The <code>_count_key</code> function is passed to
+ * <code>ch_set_each</code> to count the keys of a streamed result in the
+ * <code>int</code> at <code>p_context</code>.
+ *
+ * @param p_key const char* The key of the pair visited
+ * @param p_value void* The value of the pair visited
+ * @param p_context void* Address of the running count
+ * @return void
+ */
+static void _count_key(const char * p_key, void * p_value, void * p_context) {
+  (void) p_key;
+  (void) p_value;
+  (*(int *) p_context)++;
+}
+
+/**
+ * @brief The <code>_sleep</code> function suspends the driver for
+ * <code>milliseconds</code> milliseconds, long enough for short-lived
+ * properties to expire.
+ *
+ * @param milliseconds long int Time to sleep in milliseconds
+ * @return void
+ */
+static void _sleep(long int milliseconds) {
+
+  // Declaration
+  struct timespec duration;
+
+  // Definitions
+  duration.tv_sec = milliseconds / 1000;
+  duration.tv_nsec = (milliseconds % 1000) * 1000000;
+
+  nanosleep(&duration, NULL);
+}
+
 /**
  * @brief The <code>main</code> function, a required C function, serves as the
  * driver of the program. It contains a number of test cases that measure the
@@ -63,10 +179,37 @@ static void _print_hash_table(t_table * p_ht) {
 int main(int argc, char ** argv) {
 
   // Declarations
-  t_table * p_ht;
-  int size, value1, value2, value3, new_value3;
+  t_table * p_ht, * p_other, * p_clone;
+  t_mmap * p_map;
+  t_frozen * p_frozen;
+  t_key handle;
+  t_line_table * p_line;
+  t_cuckoo * p_cuckoo;
+  t_hopscotch * p_hop;
+  t_robin * p_robin;
+  t_robin_stats robin_stats;
+  t_shm * p_writer, * p_reader;
+  t_options options;
+  t_stats stats;
+  t_arena * p_arena;
+  t_arena_block * p_block;
+  t_allocator allocator;
+  t_numa * p_numa;
+  t_property * p_entry, * p_next;
+  t_snapshot * p_snapshot;
+  t_hamt * p_version, * p_updated, * p_old;
+  t_price_table * p_prices;
+  t_word_table * p_words;
+  double price;
+  int * p_count;
+  char keys[16][16], big[5000];
+  int values[16];
+  int size, value1, value2, value3, new_value3, inserted, i,
+    found, entries;
   char new_value1;
   float value4;
+  void ** p_slot;
+  const char * words[] = {"alpha", "beta", "alpha", "beta", "alpha"};
 
   // Definitions
   size = 4;
@@ -153,5 +296,840 @@ int main(int argc, char ** argv) {
   // Deallocate all space
   ch_destroy(p_ht);
 
+  size = 4;
+  value1 = 0;
+  value2 = 0;
+
+  printf("\n-----Case 4: Upsert word counts, table of size %d-----\n\n", size);
+  p_ht = ch_create(size);
+
+  for (i = 0; i < 5; i++) {
+    p_slot = ch_upsert(p_ht, words[i], &inserted);
+
+    // Point newly created properties at their own counter
+    if (inserted) {
+      *p_slot = (i == 0) ? &value1 : &value2;
+    }
+
+    (*(int *) *p_slot)++;
+  }
+
+  printf("Count of \"%s\": %d\n", words[0], *(int *) ch_get(p_ht, words[0]));
+  printf("Count of \"%s\": %d\n", words[1], *(int *) ch_get(p_ht, words[1]));
+
+  // Deallocate all space
+  ch_destroy(p_ht);
+
+  size = 4;
+
+  printf("\n-----Case 5: Map a frozen table of size %d from a file-----\n\n",
+    size);
+  p_ht = ch_create(size);
+
+  ch_put(p_ht, "city", "Lisbon");
+  ch_put(p_ht, "country", "Portugal");
+  ch_put(p_ht, "currency", "EUR");
+
+  printf("Write file  : %d\n", ch_mmap_write(p_ht, "chash_main.mmap",
+    _string_size));
+  ch_destroy(p_ht);
+
+  // The mapped file answers lookups once the source table is gone
+  if ((p_map = ch_mmap_open("chash_main.mmap")) != NULL) {
+    printf("Get city    : %s\n", (char *) ch_mmap_get(p_map, "city"));
+    printf("Get country : %s\n", (char *) ch_mmap_get(p_map, "country"));
+    printf("Get missing : %s\n", (ch_mmap_get(p_map, "region") == NULL)
+      ? "absent" : "present");
+    ch_mmap_close(p_map);
+  }
+
+  remove("chash_main.mmap");
+
+  size = 8;
+  value1 = 7;
+  value2 = 1370;
+  value3 = 193;
+
+  printf("\n-----Case 6: Freeze a table of size %d-----\n\n", size);
+  p_ht = ch_create(size);
+
+  ch_put(p_ht, "value 1", &value1);
+  ch_put(p_ht, "value 2", &value2);
+  ch_put(p_ht, "value 3", &value3);
+
+  p_frozen = ch_freeze(p_ht);
+
+  // Later writes to the source table do not reach the frozen copy
+  ch_delete(p_ht, "value 2");
+  ch_destroy(p_ht);
+
+  if (p_frozen != NULL) {
+    printf("Frozen slots  : %lu\n", p_frozen->size);
+    printf("Get value 1   : %d\n", *(int *) ch_frozen_get(p_frozen, "value 1"));
+    printf("Get value 2   : %d\n", *(int *) ch_frozen_get(p_frozen, "value 2"));
+    printf("Get value 3   : %d\n", *(int *) ch_frozen_get(p_frozen, "value 3"));
+    printf("Get missing   : %s\n", (ch_frozen_get(p_frozen, "value 4") ==
+      NULL) ? "absent" : "present");
+  }
+
+  ch_frozen_destroy(p_frozen);
+
+  size = 4;
+  value1 = 7;
+  value2 = 1370;
+
+  printf("\n-----Case 7: Share one key handle between two tables-----\n\n");
+  p_ht = ch_create(size);
+  p_other = ch_create(size * 16);
+  handle = ch_key("value 1");
+
+  // The handle's hash is unreduced, so it suits tables of any size
+  ch_put_h(p_ht, &handle, &value1);
+  ch_put_h(p_other, &handle, &value2);
+
+  printf("Handle length : %lu\n", handle.length);
+  printf("Hash matches  : %s\n", (handle.hash == ch_hash("value 1")) ? "yes"
+    : "no");
+  printf("Get table 1   : %d\n", *(int *) ch_get_h(p_ht, &handle));
+  printf("Get table 2   : %d\n", *(int *) ch_get(p_other, "value 1"));
+  printf("Delete table 1: %d\n", *(int *) ch_delete_h(p_ht, &handle));
+  printf("Get table 1   : %s\n", (ch_get_h(p_ht, &handle) == NULL) ? "absent"
+    : "present");
+  printf("Get table 2   : %d\n", *(int *) ch_get_h(p_other, &handle));
+
+  // Deallocate all space
+  ch_destroy(p_ht);
+  ch_destroy(p_other);
+
+  size = 1;
+
+  printf("\n-----Case 8: Fill cache-line table of size %d-----\n\n", size);
+  p_line = ch_line_create(size);
+
+  for (i = 0; i < 10; i++) {
+    sprintf(keys[i], "key %d", i);
+    values[i] = i * i;
+    ch_line_put(p_line, keys[i], &values[i]);
+  }
+
+  // Four pairs fit in the slot's own line, and the rest overflow
+  printf("Line bytes    : %lu\n", (unsigned long int) sizeof(t_line));
+  printf("Line aligned  : %s\n", ((uintptr_t) p_line->p_lines % 64 == 0)
+    ? "yes" : "no");
+  printf("First line    : %u pairs\n", p_line->p_lines[0].count);
+  printf("Overflowed    : %s\n", (p_line->p_lines[0].p_overflow != NULL)
+    ? "yes" : "no");
+  printf("Get key 9     : %d\n", *(int *) ch_line_get(p_line, keys[9]));
+  printf("Delete key 2  : %d\n", *(int *) ch_line_delete(p_line, keys[2]));
+  printf("Get key 2     : %s\n", (ch_line_get(p_line, keys[2]) == NULL)
+    ? "absent" : "present");
+  printf("Get key 3     : %d\n", *(int *) ch_line_get(p_line, keys[3]));
+
+  // Deallocate all space
+  ch_line_destroy(p_line);
+
+  size = 1;
+
+  printf("\n-----Case 9: Grow cuckoo table of size %d-----\n\n", size);
+  p_cuckoo = ch_cuckoo_create(size);
+
+  for (i = 0; i < 16; i++) {
+    sprintf(keys[i], "key %d", i);
+    values[i] = i * i;
+    ch_cuckoo_put(p_cuckoo, keys[i], &values[i]);
+  }
+
+  // Sixteen pairs cannot fit in one bucket, so the table must have doubled
+  for (i = 0, found = 0; i < 16; i++) {
+    found += ch_cuckoo_get(p_cuckoo, keys[i]) == &values[i];
+  }
+
+  printf("Buckets       : %lu\n", p_cuckoo->size);
+  printf("Pairs stored  : %lu\n", p_cuckoo->count);
+  printf("Found         : %d of 16\n", found);
+  printf("Delete key 5  : %d\n", *(int *) ch_cuckoo_delete(p_cuckoo, keys[5]));
+  printf("Get key 5     : %s\n", (ch_cuckoo_get(p_cuckoo, keys[5]) == NULL)
+    ? "absent" : "present");
+
+  // Deallocate all space
+  ch_cuckoo_destroy(p_cuckoo);
+
+  size = 16;
+
+  printf("\n-----Case 10: Load hopscotch table of size %d-----\n\n", size);
+  p_hop = ch_hopscotch_create(size);
+
+  for (i = 0; i < 14; i++) {
+    sprintf(keys[i], "key %d", i);
+    values[i] = i * i;
+    ch_hopscotch_put(p_hop, keys[i], &values[i]);
+  }
+
+  // Every key must sit within its home slot's neighborhood
+  for (i = 0, found = 0; i < (int) p_hop->size; i++) {
+    found += p_hop->p_slots[i].p_key != NULL && (i + p_hop->size -
+      p_hop->p_slots[i].hash % p_hop->size) % p_hop->size < CH_HOPSCOTCH_RANGE;
+  }
+
+  printf("Load          : %lu of %lu slots\n", p_hop->count, p_hop->size);
+  printf("In range      : %d of %lu\n", found, p_hop->count);
+  printf("Get key 13    : %d\n", *(int *) ch_hopscotch_get(p_hop, keys[13]));
+  printf("Delete key 0  : %d\n", *(int *) ch_hopscotch_delete(p_hop, keys[0]));
+  printf("Get key 0     : %s\n", (ch_hopscotch_get(p_hop, keys[0]) == NULL)
+    ? "absent" : "present");
+
+  // Deallocate all space
+  ch_hopscotch_destroy(p_hop);
+
+  size = 10;
+
+  printf("\n-----Case 11: Churn Robin Hood table of size %d-----\n\n", size);
+  p_robin = ch_robin_create(size);
+
+  for (i = 0; i < 9; i++) {
+    sprintf(keys[i], "key %d", i);
+    values[i] = i * i;
+    ch_robin_put(p_robin, keys[i], &values[i]);
+  }
+
+  ch_robin_stats(p_robin, &robin_stats);
+  printf("Before delete : %lu pairs, probe %.2f mean, %lu max\n",
+    robin_stats.count, robin_stats.average_probe, robin_stats.max_probe);
+
+  // Backward shifts close each gap, so the survivors stay reachable
+  for (i = 0; i < 9; i += 2) {
+    ch_robin_delete(p_robin, keys[i]);
+  }
+
+  for (i = 1, found = 0; i < 9; i += 2) {
+    found += ch_robin_get(p_robin, keys[i]) == &values[i];
+  }
+
+  ch_robin_stats(p_robin, &robin_stats);
+  printf("After delete  : %lu pairs, probe %.2f mean, %lu max\n",
+    robin_stats.count, robin_stats.average_probe, robin_stats.max_probe);
+  printf("Survivors     : %d of 4\n", found);
+
+  // With no tombstones left behind, an emptied table has nothing to probe
+  for (i = 1; i < 9; i += 2) {
+    ch_robin_delete(p_robin, keys[i]);
+  }
+
+  ch_robin_stats(p_robin, &robin_stats);
+  printf("Emptied       : %lu pairs, probe %lu max\n", robin_stats.count,
+    robin_stats.max_probe);
+
+  // Deallocate all space
+  ch_robin_destroy(p_robin);
+
+  size = 16;
+  value1 = 42;
+  value2 = 0;
+
+  printf("\n-----Case 12: Share table of size %d between mappings-----\n\n",
+    size);
+
+  // Clear out any segment left behind by an earlier run
+  ch_shm_unlink("/chash_main");
+  p_writer = ch_shm_create("/chash_main", size, 1UL << 16);
+  p_reader = ch_shm_open("/chash_main");
+
+  if (p_writer != NULL && p_reader != NULL) {
+    ch_shm_put(p_writer, "answer", &value1, sizeof(int));
+    ch_shm_get(p_reader, "answer", &value2, sizeof(int));
+    printf("Reader get    : %d\n", value2);
+    printf("Reader put    : %d\n", ch_shm_put(p_reader, "answer", &value2,
+      sizeof(int)));
+
+    // The writer's update is visible through the reader's own mapping
+    value1 = 7711;
+    ch_shm_put(p_writer, "answer", &value1, sizeof(int));
+    ch_shm_get(p_reader, "answer", &value2, sizeof(int));
+    printf("Updated get   : %d\n", value2);
+    ch_shm_delete(p_writer, "answer");
+    printf("Deleted get   : %ld\n", ch_shm_get(p_reader, "answer", &value2,
+      sizeof(int)));
+  }
+
+  // Deallocate all space
+  ch_shm_close(p_reader);
+  ch_shm_close(p_writer);
+  ch_shm_unlink("/chash_main");
+
+  size = 8;
+  value1 = 7;
+  value2 = 1370;
+
+  printf("\n-----Case 13: Expire keys in table of size %d-----\n\n", size);
+  p_ht = ch_create(size);
+  p_ht->p_expire = _print_expired;
+
+  ch_put_ttl(p_ht, "session", &value1, 1);
+  ch_put_ttl(p_ht, "token", &value1, 1);
+  ch_put_ttl(p_ht, "cache", &value2, 3600000);
+  ch_put(p_ht, "config", &value2);
+  _sleep(5);
+
+  // A lookup drops the expired key it finds, and a sweep drops the rest
+  printf("Get session   : %s\n", (ch_get(p_ht, "session") == NULL) ? "absent"
+    : "present");
+  printf("Swept         : %lu\n", ch_expire_step(p_ht, size));
+  printf("Get cache     : %d\n", *(int *) ch_get(p_ht, "cache"));
+  printf("Get config    : %d\n", *(int *) ch_get(p_ht, "config"));
+  printf("Remaining     : %lu\n", p_ht->count);
+
+  // Deallocate all space
+  ch_destroy(p_ht);
+
+  size = 8;
+  value1 = 7;
+  value2 = 1370;
+  value3 = 193;
+
+  printf("\n-----Case 14: Cache at most 3 keys in table of size %d-----\n\n",
+    size);
+  memset(&options, 0, sizeof(options));
+  options.capacity = 3;
+  options.p_evict = _print_evicted;
+  p_ht = ch_create_ex(size, &options);
+
+  ch_put(p_ht, "value 1", &value1);
+  ch_put(p_ht, "value 2", &value2);
+  ch_put(p_ht, "value 3", &value3);
+
+  // Reading value 1 leaves value 2 as the least recently used
+  ch_get(p_ht, "value 1");
+  ch_put(p_ht, "value 4", &value4);
+
+  printf("Count         : %lu\n", p_ht->count);
+  printf("Evictions     : %lu\n", p_ht->evictions);
+  printf("Get value 1   : %d\n", *(int *) ch_get(p_ht, "value 1"));
+  printf("Get value 2   : %s\n", (ch_get(p_ht, "value 2") == NULL) ? "absent"
+    : "present");
+
+  // Value 3 is now the oldest, so it goes next
+  ch_put(p_ht, "value 5", &value1);
+  printf("Get value 3   : %s\n", (ch_get(p_ht, "value 3") == NULL) ? "absent"
+    : "present");
+
+  // Deallocate all space
+  ch_destroy(p_ht);
+
+  size = 16;
+  memset(big, 'x', sizeof(big) - 1);
+  big[sizeof(big) - 1] = '\0';
+
+  printf("\n-----Case 15: Bound table of size %d to 4096 bytes-----\n\n",
+    size);
+  memset(&options, 0, sizeof(options));
+  options.budget = 4096;
+  options.policy = CH_BUDGET_EVICT;
+  options.p_size = _string_size;
+  p_ht = ch_create_ex(size, &options);
+
+  // Each write evicts as needed, so the budget is never exceeded
+  for (i = 0, found = 1; i < 100; i++) {
+    sprintf(keys[0], "key %d", i);
+    ch_put(p_ht, keys[0], "a value of some forty bytes in length");
+    ch_stats(p_ht, &stats);
+    found &= stats.bytes <= stats.budget;
+  }
+
+  printf("Within budget : %s\n", found ? "yes" : "no");
+  printf("Stats         : %lu keys, %lu bytes, %lu evictions\n", stats.count,
+    stats.bytes, stats.evictions);
+  printf("Put oversized : %s\n", (ch_put(p_ht, "oversized", big) == NULL)
+    ? "refused" : "stored");
+
+  // Deallocate all space
+  ch_destroy(p_ht);
+
+  // The same workload under the failing policy stops at the first refusal
+  options.policy = CH_BUDGET_FAIL;
+  p_ht = ch_create_ex(size, &options);
+
+  for (i = 0; i < 100; i++) {
+    sprintf(keys[0], "key %d", i);
+
+    if (ch_put(p_ht, keys[0], "a value of some forty bytes in length") ==
+        NULL) {
+      break;
+    }
+  }
+
+  ch_stats(p_ht, &stats);
+  printf("Failing table : %d puts, %lu keys, %lu evictions\n", i, stats.count,
+    stats.evictions);
+
+  // Deallocate all space
+  ch_destroy(p_ht);
+
+  size = 8;
+
+  printf("\n-----Case 16: Build table of size %d in an arena-----\n\n", size);
+  p_arena = ch_arena_create(4096);
+  allocator = ch_arena_allocator(p_arena);
+  memset(&options, 0, sizeof(options));
+  options.p_allocator = &allocator;
+  p_ht = ch_create_ex(size, &options);
+
+  for (i = 0; i < 10; i++) {
+    sprintf(keys[i], "key %d", i);
+    values[i] = i * i;
+    ch_put(p_ht, keys[i], &values[i]);
+  }
+
+  // The table itself must have been carved from one of the arena's blocks
+  for (p_block = p_arena->p_blocks, found = 0; p_block != NULL;
+      p_block = p_block->p_next) {
+    found += (uintptr_t) p_ht > (uintptr_t) p_block &&
+      (uintptr_t) p_ht < (uintptr_t) (p_block + 1) + p_block->size;
+  }
+
+  printf("Table in arena: %s\n", found ? "yes" : "no");
+  printf("Get key 7     : %d\n", *(int *) ch_get(p_ht, keys[7]));
+  printf("Delete key 7  : %d\n", *(int *) ch_delete(p_ht, keys[7]));
+  printf("Get key 7     : %s\n", (ch_get(p_ht, keys[7]) == NULL) ? "absent"
+    : "present");
+
+  // Releasing the arena releases the table along with it
+  ch_arena_destroy(p_arena);
+
+  size = 8;
+  value1 = 7;
+  value2 = 0;
+
+  printf("\n-----Case 17: Replicate table of size %d on 2 nodes-----\n\n",
+    size);
+
+  // The node is simulated, so the case runs on single-node machines as well
+  p_numa = ch_numa_create(size, 2, _node, &value2);
+
+  if (p_numa != NULL) {
+    ch_numa_put(p_numa, "value 1", &value1);
+
+    for (value2 = 0; value2 < 2; value2++) {
+      printf("Node %d get    : %d (%lu in replica)\n", value2,
+        *(int *) ch_numa_get(p_numa, "value 1"),
+        p_numa->p_replicas[value2]->count);
+    }
+
+    printf("Delete value 1: %d\n", *(int *) ch_numa_delete(p_numa,
+      "value 1"));
+
+    for (value2 = 0; value2 < 2; value2++) {
+      printf("Node %d get    : %s\n", value2, (ch_numa_get(p_numa,
+        "value 1") == NULL) ? "absent" : "present");
+    }
+  }
+
+  // Deallocate all space
+  ch_numa_destroy(p_numa);
+
+  size = 300000;
+
+  printf("\n-----Case 18: Map table of size %d on huge pages-----\n\n", size);
+  memset(&options, 0, sizeof(options));
+  options.huge_pages = 1;
+  p_ht = ch_create_ex(size, &options);
+
+  for (i = 0; i < 16; i++) {
+    sprintf(keys[i], "key %d", i);
+    values[i] = i * i;
+    ch_put(p_ht, keys[i], &values[i]);
+  }
+
+  // Either kind of huge page needs whole 2MB pages on a 2MB boundary
+  ch_stats(p_ht, &stats);
+  printf("Mapped bytes  : %lu\n", p_ht->mapped);
+  printf("Aligned to 2MB: %s\n", ((uintptr_t) p_ht->p_entries % (1UL << 21) ==
+    0) ? "yes" : "no");
+  printf("Backing       : %s\n", (stats.pages == CH_PAGES_EXPLICIT)
+    ? "reserved huge pages" : (stats.pages == CH_PAGES_TRANSPARENT)
+    ? "transparent huge pages" : "normal pages");
+  printf("Get key 15    : %d\n", *(int *) ch_get(p_ht, keys[15]));
+
+  // Deallocate all space
+  ch_destroy(p_ht);
+
+  size = 4000000;
+
+  printf("\n-----Case 19: Create sparse table of size %d-----\n\n", size);
+  p_ht = ch_create(size);
+
+  for (i = 0; i < 16; i++) {
+    sprintf(keys[i], "key %d", i);
+    values[i] = i * i;
+    ch_put(p_ht, keys[i], &values[i]);
+  }
+
+  // Clearing stops after the last property rather than visiting every slot
+  ch_clear(p_ht);
+
+  // Every slot must read as empty, though only those used were ever written
+  for (i = 0, found = 0; i < size; i++) {
+    found += p_ht->p_entries[i] == NULL;
+  }
+
+  printf("Empty slots   : %d of %d\n", found, size);
+  printf("Get key 3     : %s\n", (ch_get(p_ht, keys[3]) == NULL) ? "absent"
+    : "present");
+  printf("Put key 3     : %d\n", *(int *) ch_put(p_ht, keys[3], &values[3]));
+
+  // Deallocate all space
+  ch_destroy(p_ht);
+
+  size = 4;
+
+  printf("\n-----Case 20: Grow, shrink and compact table of size %d-----\n\n",
+    size);
+  memset(&options, 0, sizeof(options));
+  options.low_watermark = 25;
+  options.min_size = 4;
+  p_ht = ch_create_ex(size, &options);
+
+  for (i = 0; i < 16; i++) {
+    sprintf(keys[i], "key %d", i);
+    values[i] = i * i;
+    ch_put(p_ht, keys[i], &values[i]);
+  }
+
+  printf("Size at 16    : %lu slots\n", p_ht->size);
+
+  // Deleting all but two keys drops the load below a quarter
+  for (i = 2; i < 16; i++) {
+    ch_delete(p_ht, keys[i]);
+  }
+
+  printf("Size at 2     : %lu slots\n", p_ht->size);
+  printf("Compact       : %d\n", ch_compact(p_ht));
+
+  // Compaction lays the survivors out back to back in slot order
+  for (i = 0, found = 1, p_entry = NULL; i < (int) p_ht->size; i++) {
+    for (p_next = p_ht->p_entries[i]; p_next != NULL;
+        p_next = p_next->p_next) {
+      found &= p_entry == NULL || p_next == p_entry + 1;
+      p_entry = p_next;
+    }
+  }
+
+  printf("Contiguous    : %s\n", found ? "yes" : "no");
+  printf("Get key 1     : %d\n", *(int *) ch_get(p_ht, keys[1]));
+
+  // Deallocate all space
+  ch_destroy(p_ht);
+
+  size = 4;
+  value1 = 7;
+
+  printf("\n-----Case 21: Reserve 100 keys in table of size %d-----\n\n",
+    size);
+  p_ht = ch_create(size);
+
+  printf("Reserve       : %d\n", ch_reserve(p_ht, 100));
+  printf("Reserved      : %lu slots, %lu spare properties\n", p_ht->size,
+    p_ht->spares);
+
+  // The bulk load draws on the spares and never resizes the slot array
+  for (i = 0; i < 100; i++) {
+    sprintf(keys[0], "key %d", i);
+    ch_put(p_ht, keys[0], &value1);
+  }
+
+  printf("Loaded        : %lu slots, %lu spare properties, %lu keys\n",
+    p_ht->size, p_ht->spares, p_ht->count);
+  printf("Get key 99    : %d\n", *(int *) ch_get(p_ht, "key 99"));
+
+  // Deallocate all space
+  ch_destroy(p_ht);
+
+  size = 4;
+  value1 = 7;
+  value2 = 1370;
+  value3 = 193;
+  new_value3 = 7711;
+
+  printf("\n-----Case 22: Snapshot table of size %d during writes-----\n\n",
+    size);
+  p_ht = ch_create(size);
+
+  ch_put(p_ht, "value 1", &value1);
+  ch_put(p_ht, "value 2", &value2);
+  p_snapshot = ch_snapshot(p_ht);
+
+  // Writes after the snapshot reach the table but not the snapshot
+  ch_put(p_ht, "value 1", &new_value3);
+  ch_delete(p_ht, "value 2");
+  ch_put(p_ht, "value 3", &value3);
+
+  if (p_snapshot != NULL) {
+    printf("Table value 1 : %d\n", *(int *) ch_get(p_ht, "value 1"));
+    printf("Snap value 1  : %d\n", *(int *) ch_snapshot_get(p_snapshot,
+      "value 1"));
+    printf("Table value 2 : %s\n", (ch_get(p_ht, "value 2") == NULL)
+      ? "absent" : "present");
+    printf("Snap value 2  : %d\n", *(int *) ch_snapshot_get(p_snapshot,
+      "value 2"));
+    printf("Table value 3 : %d\n", *(int *) ch_get(p_ht, "value 3"));
+    printf("Snap value 3  : %s\n", (ch_snapshot_get(p_snapshot, "value 3") ==
+      NULL) ? "absent" : "present");
+    ch_snapshot_release(p_ht, p_snapshot);
+  }
+
+  // Deallocate all space
+  ch_destroy(p_ht);
+
+  value1 = 7711;
+
+  printf("\n-----Case 23: Derive versions of a persistent map-----\n\n");
+  p_version = ch_hamt_create();
+
+  for (i = 0; i < 16; i++) {
+    sprintf(keys[i], "key %d", i);
+    values[i] = i * i;
+    p_old = p_version;
+    p_version = ch_hamt_put(p_old, keys[i], &values[i]);
+    ch_hamt_release(p_old);
+  }
+
+  // Each derived version leaves the one it came from untouched
+  p_updated = ch_hamt_put(p_version, keys[0], &value1);
+  p_old = ch_hamt_delete(p_updated, keys[1]);
+
+  printf("Counts        : %lu, %lu, %lu\n", p_version->count,
+    p_updated->count, p_old->count);
+  printf("Key 0         : %d, %d, %d\n",
+    *(int *) ch_hamt_get(p_version, keys[0]),
+    *(int *) ch_hamt_get(p_updated, keys[0]),
+    *(int *) ch_hamt_get(p_old, keys[0]));
+  printf("Key 1 deleted : %s\n", (ch_hamt_get(p_old, keys[1]) == NULL &&
+    ch_hamt_get(p_updated, keys[1]) == &values[1]) ? "in latest only" : "no");
+
+  // Only the root entry on the path to the updated key was copied
+  for (i = 0, entries = 0; i < 32; i++) {
+    entries += (p_version->p_root->datamap | p_version->p_root->nodemap) >>
+      i & 1;
+  }
+
+  for (i = 0, found = 0; i < entries; i++) {
+    found += p_version->p_root->p_slots[i] == p_updated->p_root->p_slots[i];
+  }
+
+  printf("Shared entries: %d of %d\n", found, entries);
+
+  // Deallocate all space
+  ch_hamt_release(p_old);
+  ch_hamt_release(p_updated);
+  ch_hamt_release(p_version);
+
+  size = 4;
+  value1 = 7;
+  value2 = 1370;
+  value3 = 193;
+  new_value3 = 7711;
+
+  printf("\n-----Case 24: Clone and merge tables of size %d-----\n\n", size);
+  p_ht = ch_create(size);
+  p_other = ch_create(size);
+
+  ch_put(p_ht, "value 1", &value1);
+  ch_put(p_ht, "value 2", &value2);
+  ch_put(p_other, "value 2", &value3);
+  ch_put(p_other, "value 3", &new_value3);
+
+  // The clone is independent of its original, though the values are shared
+  p_clone = ch_clone(p_ht);
+  ch_delete(p_clone, "value 1");
+
+  printf("Clone count   : %lu of %lu\n", p_clone->count, p_ht->count);
+  printf("Original 1    : %d\n", *(int *) ch_get(p_ht, "value 1"));
+
+  // Keeping the destination's values only adds the keys it lacks
+  printf("Merge keep    : %d\n", ch_merge(p_clone, p_other, CH_MERGE_KEEP));
+  printf("Kept 2, 3     : %d, %d\n", *(int *) ch_get(p_clone, "value 2"),
+    *(int *) ch_get(p_clone, "value 3"));
+  printf("Merge replace : %d\n", ch_merge(p_ht, p_other, CH_MERGE_REPLACE));
+  printf("Replaced 2, 3 : %d, %d\n", *(int *) ch_get(p_ht, "value 2"),
+    *(int *) ch_get(p_ht, "value 3"));
+  printf("Merge unknown : %d\n", ch_merge(p_ht, p_other, 7));
+
+  // Deallocate all space
+  ch_destroy(p_clone);
+  ch_destroy(p_other);
+  ch_destroy(p_ht);
+
+  size = 4;
+  value1 = 7;
+  value2 = 1370;
+  value3 = 193;
+  new_value3 = 7711;
+
+  printf("\n-----Case 25: Combine the keys of tables of size %d-----\n\n",
+    size);
+  p_ht = ch_create(size);
+  p_other = ch_create(size);
+
+  ch_put(p_ht, "value 1", &value1);
+  ch_put(p_ht, "value 2", &value2);
+  ch_put(p_ht, "value 3", &value3);
+  ch_put(p_other, "value 2", &new_value3);
+  ch_put(p_other, "value 3", &new_value3);
+  ch_put(p_other, "value 4", &new_value3);
+
+  p_clone = ch_set(p_ht, p_other, CH_SET_UNION);
+  printf("Union         : %lu keys\n", p_clone->count);
+  ch_destroy(p_clone);
+
+  // Keys present on the left take their values from the left
+  p_clone = ch_set(p_ht, p_other, CH_SET_INTERSECTION);
+  printf("Intersection  : %lu keys, value 2 is %d\n", p_clone->count,
+    *(int *) ch_get(p_clone, "value 2"));
+  ch_destroy(p_clone);
+
+  p_clone = ch_set(p_ht, p_other, CH_SET_DIFFERENCE);
+  printf("Difference    : %lu keys, value 1 %s\n", p_clone->count,
+    (ch_get(p_clone, "value 1") != NULL) ? "present" : "absent");
+  ch_destroy(p_clone);
+
+  // Two partitions streamed separately cover the union exactly once
+  found = 0;
+  ch_set_each(p_ht, p_other, CH_SET_UNION, 0, 2, _count_key, &found);
+  ch_set_each(p_ht, p_other, CH_SET_UNION, 1, 2, _count_key, &found);
+  printf("Streamed union: %d keys\n", found);
+
+  // Deallocate all space
+  ch_destroy(p_other);
+  ch_destroy(p_ht);
+
+  size = 8;
+
+  printf("\n-----Case 26: Cache 2 keys within 4096 bytes, size %d-----\n\n",
+    size);
+  memset(&options, 0, sizeof(options));
+  options.capacity = 2;
+  options.budget = 4096;
+  options.policy = CH_BUDGET_FAIL;
+  options.p_size = _string_size;
+  options.p_evict = _print_evicted;
+  p_ht = ch_create_ex(size, &options);
+
+  ch_put(p_ht, "value 1", "a");
+  ch_put(p_ht, "value 2", "b");
+
+  // A refused write must not have evicted anything to make room for itself
+  printf("Put oversized : %s\n", (ch_put(p_ht, "value 3", big) == NULL)
+    ? "refused" : "stored");
+  printf("Count         : %lu\n", p_ht->count);
+  printf("Get value 1   : %s\n", (char *) ch_get(p_ht, "value 1"));
+
+  // An accepted write evicts the least recently used, now value 2
+  printf("Put value 3   : %s\n", (char *) ch_put(p_ht, "value 3", "c"));
+  printf("Get value 2   : %s\n", (ch_get(p_ht, "value 2") == NULL) ? "absent"
+    : "present");
+  ch_destroy(p_ht);
+
+  // Nor does an oversized write evict under the evicting policy
+  options.policy = CH_BUDGET_EVICT;
+  p_ht = ch_create_ex(size, &options);
+
+  ch_put(p_ht, "value 1", "a");
+  ch_put(p_ht, "value 2", "b");
+  printf("Put oversized : %s\n", (ch_put(p_ht, "value 3", big) == NULL)
+    ? "refused" : "stored");
+  printf("Count         : %lu, %lu evictions\n", p_ht->count,
+    p_ht->evictions);
+
+  // Deallocate all space
+  ch_destroy(p_ht);
+
+  size = 1;
+
+  printf("\n-----Case 27: Move found keys to front, size %d-----\n\n", size);
+  p_ht = ch_create(size);
+  p_ht->flags = CH_MOVE_TO_FRONT;
+
+  ch_put(p_ht, "value 1", "a");
+  ch_put(p_ht, "value 2", "b");
+  ch_put(p_ht, "value 3", "c");
+  ch_put(p_ht, "value 4", "d");
+  _print_hash_table(p_ht);
+
+  // A lookup promotes the tail key to the head, where repeats leave it
+  for (i = 0; i < 2; i++) {
+    printf("\nGet value 4   : %s\n", (char *) ch_get(p_ht, "value 4"));
+    printf("Head          : %s\n", p_ht->p_entries[0]->p_key);
+  }
+
+
+  printf("\nGet value 3   : %s\n", (char *) ch_get(p_ht, "value 3"));
+  printf("Head          : %s\n", p_ht->p_entries[0]->p_key);
+  _print_hash_table(p_ht);
+
+  // Deletion and insertion still find their places in the reordered chain
+  printf("\nDelete value 1: %s\n", (char *) ch_delete(p_ht, "value 1"));
+  printf("Get value 1   : %s\n", (ch_get(p_ht, "value 1") == NULL) ? "absent"
+    : "present");
+  printf("Put value 2   : %s\n", (char *) ch_put(p_ht, "value 2", "e"));
+  printf("Put value 5   : %s\n", (char *) ch_put(p_ht, "value 5", "f"));
+  printf("Get value 2   : %s\n", (char *) ch_get(p_ht, "value 2"));
+  printf("Count         : %lu\n", p_ht->count);
+  _print_hash_table(p_ht);
+
+  // Deallocate all space
+  ch_destroy(p_ht);
+
+  size = 4;
+
+  printf("\n-----Case 28: Generated typed tables, size %d-----\n\n", size);
+  p_prices = ch_price_create(size);
+  p_words = ch_word_create(size);
+
+  // Integer keys strided by the table size still spread over its slots
+  for (i = 0; i < 8; i++) {
+    ch_price_put(p_prices, 1024L * i, 1.5 * i);
+  }
+
+  for (i = 0, entries = 0; i < size; i++) {
+    entries += (p_prices->p_entries[i] != NULL);
+  }
+
+  printf("Slots in use  : %d of %d\n", entries, size);
+  printf("Get 3072      : %.2f\n", *ch_price_get(p_prices, 3072L));
+  printf("Put 3072      : %.2f\n", *ch_price_put(p_prices, 3072L, 9.75));
+  found = ch_price_delete(p_prices, 3072L, &price);
+  printf("Delete 3072   : %d, %.2f\n", found, price);
+  printf("Get 3072      : %s\n", (ch_price_get(p_prices, 3072L) == NULL)
+    ? "absent" : "present");
+  printf("Delete 3072   : %d\n", ch_price_delete(p_prices, 3072L, NULL));
+
+  // String keys compare by content, so each word is counted once per use
+  for (i = 0; i < (int) (sizeof(words) / sizeof(words[0])); i++) {
+    if ((p_count = ch_word_get(p_words, words[i])) != NULL) {
+      (*p_count)++;
+    } else {
+      ch_word_put(p_words, words[i], 1);
+    }
+  }
+
+  printf("Get alpha     : %d\n", *ch_word_get(p_words, "alpha"));
+  printf("Get beta      : %d\n", *ch_word_get(p_words, "beta"));
+  printf("Delete beta   : %d\n", ch_word_delete(p_words, "beta", NULL));
+  printf("Get beta      : %s\n", (ch_word_get(p_words, "beta") == NULL)
+    ? "absent" : "present");
+
+  // Clearing empties both tables, which remain usable
+  ch_price_clear(p_prices);
+  ch_word_clear(p_words);
+  printf("Get 0 cleared : %s\n", (ch_price_get(p_prices, 0L) == NULL)
+    ? "absent" : "present");
+  printf("Get alpha     : %s\n", (ch_word_get(p_words, "alpha") == NULL)
+    ? "absent" : "present");
+  ch_word_put(p_words, "gamma", 3);
+  printf("Get gamma     : %d\n", *ch_word_get(p_words, "gamma"));
+
+  // Deallocate all space
+  ch_price_destroy(p_prices);
+  ch_word_destroy(p_words);
+
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,135 @@
+/**
+ * @file main.cpp
+ * @author Andrew Eissen <andrew@andreweissen.com>
+ * @date 7 July 2021
+ * @brief Source file used solely to test the C++ interface to CHash declared
+ * in chash.hpp. As that interface is header-only, the driver is built on its
+ * own, e.g. <code>g++ -std=c++17 main.cpp -o main_cpp</code>
+ */
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "chash.hpp"
+
+/**
+ * @brief The <code>counted</code> <code>struct</code> is a value type that
+ * tallies how many times it has been constructed, so that the driver can show
+ * <code>try_emplace</code> building a value only for an absent key.
+ */
+struct counted {
+  static int constructions;
+  int value;
+
+  explicit counted(int value) : value(value) {
+    constructions++;
+  }
+};
+
+int counted::constructions = 0;
+
+/**
+ * @brief The <code>_print_map</code> function prints every key/value pair of
+ * <code>map</code> in iteration order, that is slot by slot, on one line.
+ *
+ * @param label const char* Text printed before the pairs
+ * @param map const chash::map<std::string, int>& The map to be printed
+ * @return void
+ */
+static void _print_map(const char * label,
+    const chash::map<std::string, int> & map) {
+
+  printf("%-14s: ", label);
+
+  for (const auto & entry : map) {
+    printf("\"%s\": %d ", entry.first.c_str(), entry.second);
+  }
+
+  printf("(%zu keys, %zu slots)\n", map.size(), map.bucket_count());
+}
+
+int main(void) {
+
+  // Declarations
+  chash::map<std::string, int> words(4), moved, assigned;
+  chash::map<int, counted> objects(4);
+  std::string_view line;
+  const int * p_before;
+  bool inserted;
+  int counter;
+
+  // Definitions
+  line = "alpha beta gamma";
+
+  printf("\n-----Case 1: Emplace only absent keys-----\n\n");
+
+  inserted = objects.try_emplace(1, 10).second;
+  printf("Emplace 1     : %s, %d constructed\n", inserted ? "inserted"
+    : "found", counted::constructions);
+
+  // The value for a present key must not be built, let alone stored
+  inserted = objects.try_emplace(1, 20).second;
+  printf("Emplace 1     : %s, %d constructed\n", inserted ? "inserted"
+    : "found", counted::constructions);
+  printf("Get 1         : %d\n", objects.at(1).value);
+
+  printf("\n-----Case 2: Look up by string view-----\n\n");
+
+  words.try_emplace(std::string_view("alpha"), 1);
+  words.try_emplace("beta", 2);
+  words["gamma"] = 3;
+  _print_map("Words", words);
+
+  // Views into a longer string are hashed and compared without a copy
+  printf("Find beta     : %d\n", words.find(line.substr(6, 4))->second);
+  printf("Find gamma    : %d\n", words.at(line.substr(11)));
+  printf("Find alph     : %s\n", words.contains(line.substr(0, 4))
+    ? "present" : "absent");
+  printf("Erase alpha   : %zu\n", words.erase(line.substr(0, 5)));
+  _print_map("Words", words);
+
+  printf("\n-----Case 3: Move and reuse-----\n\n");
+
+  moved = std::move(words);
+  _print_map("Moved to", moved);
+  _print_map("Moved from", words);
+
+  // A moved-from map has no slots, but accepts lookups and new keys
+  printf("Find beta     : %s\n", words.contains("beta") ? "present"
+    : "absent");
+  words["delta"] = 4;
+  _print_map("Reused", words);
+
+  assigned = chash::map<std::string, int>(std::move(moved));
+  _print_map("Constructed", assigned);
+  _print_map("Moved from", moved);
+
+  printf("\n-----Case 4: Rehash by cached hash-----\n\n");
+
+  for (counter = 0; counter < 12; counter++) {
+    assigned.try_emplace("key " + std::to_string(counter), counter);
+  }
+
+  _print_map("Before", assigned);
+  p_before = &assigned.at("key 7");
+
+  // Nodes are relinked in place, so references into the map stay valid
+  assigned.rehash(64);
+  printf("Slots         : %zu\n", assigned.bucket_count());
+  printf("Get key 7     : %d, %s node\n", assigned.at("key 7"),
+    (&assigned.at("key 7") == p_before) ? "same" : "new");
+
+  for (counter = 0, inserted = true; counter < 12; counter++) {
+    inserted = inserted && assigned.at("key " + std::to_string(counter)) ==
+      counter;
+  }
+
+  printf("Keys found    : %s\n", inserted ? "all" : "not all");
+
+  // Shrinking stops at one slot per key
+  assigned.rehash(1);
+  _print_map("Shrunk", assigned);
+
+  return 0;
+}